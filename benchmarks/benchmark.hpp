@@ -0,0 +1,51 @@
+#ifndef HPP_NETWORKMONITOR_BENCHMARK_
+#define HPP_NETWORKMONITOR_BENCHMARK_
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+namespace NetworkMonitor::Benchmark {
+
+/*! \brief Prevent the compiler from optimising away a value computed by a benchmark.
+ */
+template <typename T>
+inline void doNotOptimise(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/*! \brief Print the time per operation and the throughput of a benchmark.
+ */
+inline void report(std::string_view name, double nsPerCall) {
+    std::cout << std::left << std::setw(40) << name << std::right
+              << std::setw(14) << std::fixed << std::setprecision(1) << nsPerCall << " ns/op"
+              << std::setw(16) << std::setprecision(0) << 1e9 / nsPerCall << " op/s"
+              << std::endl;
+}
+
+/*! \brief Time `iterations` calls to `fn` and print the time per call and the throughput.
+ *
+ *  \param fn Called with the iteration number, as a size_t.
+ *
+ *  \returns The time per call, in nanoseconds.
+ */
+template <typename Fn>
+double measure(std::string_view name, std::size_t iterations, Fn&& fn) {
+    // Warm up caches and lazily allocated buffers.
+    fn(std::size_t{0});
+
+    const auto start = std::chrono::steady_clock::now();
+    for(std::size_t i=0; i<iterations; ++i)
+        fn(i);
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double nsPerCall = elapsed.count() / static_cast<double>(iterations);
+    report(name, nsPerCall);
+    return nsPerCall;
+}
+
+} // namespace NetworkMonitor::Benchmark
+
+#endif // HPP_NETWORKMONITOR_BENCHMARK_
@@ -0,0 +1,129 @@
+#include "../../tests/network_monitor/loopback_stomp_broker.hpp"
+#include "../passenger_events.hpp"
+
+#include <network_monitor/file_downloader.hpp>
+#include <network_monitor/latency_histogram.hpp>
+#include <network_monitor/stomp_client.hpp>
+#include <network_monitor/websocket_client.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::Benchmark::makePassengerEvents;
+using NetworkMonitor::BoostWebSocketClient;
+using NetworkMonitor::LatencyHistogram;
+using NetworkMonitor::LoopbackStompBroker;
+using NetworkMonitor::StompClient;
+using NetworkMonitor::StompClientError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::sentAt;
+
+namespace {
+
+/*  Have a loopback broker publish `count` passenger events at `rate` messages per second (as
+ *  fast as possible if 0), and print the throughput and the latency from the broker queueing a
+ *  message to the subscription handler getting it parsed.
+ */
+void subscribeThroughput(std::string_view name, const std::vector<std::string>& events,
+                         double rate, std::size_t count)
+{
+    // The broker runs on its own thread, as a remote one would.
+    boost::asio::io_context serverIoc{};
+    LoopbackStompBroker broker{serverIoc, {events, rate, count}};
+    auto work = boost::asio::make_work_guard(serverIoc);
+    std::thread serverThread{[&serverIoc]() {
+        serverIoc.run();
+    }};
+
+    boost::asio::io_context ioc{};
+    boost::asio::ssl::context ctx{boost::asio::ssl::context::tlsv12_client};
+    StompClient<BoostWebSocketClient> client{"127.0.0.1", "/", std::to_string(broker.port() ), ioc, ctx};
+
+    LatencyHistogram latency{};
+    std::size_t received = 0;
+    std::chrono::steady_clock::time_point start{};
+    std::chrono::steady_clock::time_point end{};
+    const auto onMessage = [&](StompClientError ec, const StompFrame& frame) {
+        if(ec != StompClientError::Ok) {
+            std::cerr << "Invalid message: " << ec << std::endl;
+            return;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        latency.record(now - sentAt(frame) );
+        if(++received == count) {
+            end = now;
+            client.close();
+        }
+    };
+    client.connect("benchmark", "benchmark", [&](StompClientError ec) {
+        if(ec != StompClientError::Ok) {
+            std::cerr << "Could not connect to the loopback broker: " << ec << std::endl;
+            return;
+        }
+        start = std::chrono::steady_clock::now();
+        client.subscribeFrames("/passengers", [&](StompClientError ec, std::string&&) {
+            if(ec != StompClientError::Ok) {
+                std::cerr << "Could not subscribe: " << ec << std::endl;
+                client.close();
+            }
+        }, onMessage);
+    });
+    ioc.run();
+
+    work.reset();
+    serverIoc.stop();
+    serverThread.join();
+    if(received != count) {
+        std::cerr << "Only " << received << " of " << count << " messages received" << std::endl;
+        return;
+    }
+
+    const std::chrono::duration<double> elapsed = end - start;
+    const auto us = [](std::chrono::nanoseconds ns) {
+        return std::chrono::duration<double, std::micro>(ns).count();
+    };
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << static_cast<double>(count) / elapsed.count()
+              << std::setw(12) << us(latency.percentile(0.5) )
+              << std::setw(12) << us(latency.percentile(0.99) )
+              << std::setw(12) << us(latency.max() )
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+
+    const auto layout = NetworkMonitor::parseJsonFile(TEST_NETWORK_LAYOUT);
+    if(layout.empty() ) {
+        std::cerr << "Unable to parse " << TEST_NETWORK_LAYOUT << std::endl;
+        return EXIT_FAILURE;
+    }
+    const auto events = makePassengerEvents(layout, 10000);
+
+    std::cout << "STOMP over TLS WebSocket on 127.0.0.1, " << count << " passenger events per run" << std::endl;
+    std::cout << std::left << std::setw(16) << "rate (msg/s)" << std::right
+              << std::setw(12) << "msg/s" << std::setw(12) << "p50 us"
+              << std::setw(12) << "p99 us" << std::setw(12) << "max us" << std::endl;
+
+    // Paced runs last a few seconds each: they show the latency of a broker that keeps up.
+    for(const double rate : {1000.0, 10000.0, 50000.0}) {
+        const auto paced = std::min(count, static_cast<std::size_t>(rate * 3) );
+        subscribeThroughput(std::to_string(static_cast<std::size_t>(rate) ), events, rate, paced);
+    }
+    // Unpaced, the latency is mostly the time queued by the broker behind the other messages.
+    subscribeThroughput("unpaced", events, 0, count);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+#include "../benchmark.hpp"
+
+#include <network_monitor/stomp_frame.hpp>
+
+#include <boost/fusion/adapted/std_pair.hpp>
+#include <boost/fusion/adapted/std_tuple.hpp>
+#include <boost/spirit/home/x3.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::Benchmark::doNotOptimise;
+using NetworkMonitor::Benchmark::measure;
+using NetworkMonitor::StompCommand;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompFrameWriter;
+using NetworkMonitor::StompHeader;
+
+namespace {
+
+/*  The Spirit X3 parser StompFrame used before the hand-written scanner, kept as a baseline.
+ *  Like the original, it copies every header into a map and reports unknown names by throwing.
+ */
+struct LegacyFrame {
+    std::string frame{};
+    std::string command{};
+    std::unordered_map<StompHeader, std::string> headerMp{};
+    std::string body{};
+};
+
+StompHeader legacyToStompHeader(std::string_view sh) {
+    static const std::array<std::string_view, NetworkMonitor::StompHeader_count> lookup = {
+        "accept-version", "ack", "content-length", "content-type", "destination",
+        "heart-beat", "host", "id", "login", "message-id", "passcode",
+        "receipt", "receipt-id", "session", "subscription", "version",
+    };
+    for(std::size_t i=0; i<lookup.size(); ++i) {
+        if(lookup[i] == sh)
+            return static_cast<StompHeader>(i);
+    }
+    throw std::runtime_error("Invalid stomp header: " + std::string(sh) );
+}
+
+bool legacyParse(LegacyFrame& out, std::string frame) {
+    namespace Parser = boost::spirit::x3;
+    out.frame = std::move(frame);
+    const auto eol = -Parser::lit('\r') >> '\n';
+    constexpr auto command = Parser::string("SEND\n")
+                           | Parser::string("SUBSCRIBE\n")
+                           | Parser::string("DISCONNECT\n")
+                           | Parser::string("CONNECT\n")
+                           | Parser::string("STOMP\n")
+                           | Parser::string("CONNECTED\n")
+                           | Parser::string("MESSAGE\n")
+                           | Parser::string("RECEIPT\n")
+                           | Parser::string("ERROR\n");
+    const auto invalidHeaderChar = Parser::lit(':') | '\r' | '\n';
+    const auto headerChar = Parser::char_ - invalidHeaderChar;
+    const auto header = (+headerChar >> ':' >> *headerChar);
+    const auto grammar = command >> *(header >> eol) >> eol >> *Parser::char_;
+
+    std::tuple<std::string, std::vector<std::pair<std::string, std::string> >, std::string> parsed;
+    if(!Parser::parse(out.frame.cbegin(), out.frame.cend(), grammar, parsed) )
+        return false;
+    try {
+        out.command = std::move(std::get<0>(parsed) );
+        auto& headerLst = std::get<1>(parsed);
+        for(auto iter = headerLst.rbegin(); iter != headerLst.rend(); ++iter)
+            out.headerMp[legacyToStompHeader(iter->first)] = std::move(iter->second);
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    out.body = std::move(std::get<2>(parsed) );
+    while(!out.body.empty() && out.body.back() != '\0')
+        out.body.pop_back();
+    return !out.body.empty();
+}
+
+std::string makePassengerFrame(std::size_t i) {
+    const std::string body =
+        R"({"datetime":"2020-11-01T07:18:50.234000Z","passenger_event":"in","station_id":"station_)"
+        + std::to_string(i % 400) + R"("})";
+    StompError error;
+    const StompFrame frame {
+        error,
+        StompCommand::Message,
+        {
+            {StompHeader::Subscription, "1"},
+            {StompHeader::MessageId, std::to_string(i)},
+            {StompHeader::Destination, "/passengers"},
+            {StompHeader::ContentLength, std::to_string(body.size() )},
+            {StompHeader::ContentType, "application/json"},
+        },
+        body
+    };
+    if(error != StompError::Ok)
+        throw std::runtime_error("Invalid benchmark frame");
+    return frame.toString();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    std::vector<std::string> frames;
+    for(std::size_t i=0; i<1024; ++i)
+        frames.push_back(makePassengerFrame(i) );
+    std::cout << "Passenger frame: " << frames[0].size() << " bytes" << std::endl;
+
+    // Both parsers receive a copy of the frame, as they would a message moved in from the socket.
+    const double legacyNs = measure("X3 parser (legacy)", iterations, [&](std::size_t i) {
+        LegacyFrame frame{};
+        doNotOptimise(legacyParse(frame, frames[i % frames.size()]) );
+        doNotOptimise(frame.headerMp.size() );
+    });
+    const double scannerNs = measure("StompFrame", iterations, [&](std::size_t i) {
+        StompError error;
+        StompFrame frame{error, std::string(frames[i % frames.size()])};
+        doNotOptimise(error);
+        doNotOptimise(frame.getBody().size() );
+    });
+    std::cout << "Speed-up: " << legacyNs / scannerNs << "x" << std::endl;
+
+    // Serialising a SEND frame, with a destination that needs escaping.
+    const std::string destination = "/passengers:station_211";
+    const auto bodyBegin = frames[0].find("\n\n") + 2;
+    const std::string body = frames[0].substr(bodyBegin, frames[0].size() - bodyBegin - 1);
+    measure("StompFrame from components", iterations, [&](std::size_t i) {
+        StompError error;
+        const StompFrame frame {
+            error,
+            StompCommand::Send,
+            {
+                {StompHeader::Destination, destination},
+                {StompHeader::ContentType, "application/json"},
+            },
+            body
+        };
+        doNotOptimise(frame.toStringView().data() );
+    });
+    std::string out{};
+    measure("StompFrameWriter (reused buffer)", iterations, [&](std::size_t i) {
+        out.clear();
+        doNotOptimise(StompFrameWriter::write(
+            out,
+            StompCommand::Send,
+            {
+                {StompHeader::Destination, destination},
+                {StompHeader::ContentType, "application/json"},
+            },
+            body
+        ) );
+        doNotOptimise(out.data() );
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+#include "../benchmark.hpp"
+
+#include <network_monitor/file_downloader.hpp>
+#include <network_monitor/transport_network.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using NetworkMonitor::Benchmark::doNotOptimise;
+using NetworkMonitor::Benchmark::measure;
+using NetworkMonitor::Id;
+using NetworkMonitor::TransportNetwork;
+
+namespace {
+
+std::string suffixed(const nlohmann::json& id, std::size_t copy) {
+    return id.get<std::string>() + "_" + std::to_string(copy);
+}
+
+/*  Make `copies` copies of the layout, then link each copy to the next one with
+ *  connector lines every `connectorStride` stations, so the result is a single network.
+ */
+nlohmann::json scaleLayout(const nlohmann::json& layout, std::size_t copies, std::size_t connectorStride) {
+    nlohmann::json scaled{
+        {"stations", nlohmann::json::array()},
+        {"lines", nlohmann::json::array()},
+        {"travel_times", nlohmann::json::array()},
+    };
+    for(std::size_t copy=0; copy<copies; ++copy) {
+        for(auto station : layout.at("stations") ) {
+            station["station_id"] = suffixed(station.at("station_id"), copy);
+            scaled["stations"].push_back(std::move(station) );
+        }
+        for(auto line : layout.at("lines") ) {
+            line["line_id"] = suffixed(line.at("line_id"), copy);
+            for(auto& route : line["routes"]) {
+                route["route_id"] = suffixed(route.at("route_id"), copy);
+                route["start_station_id"] = suffixed(route.at("start_station_id"), copy);
+                route["end_station_id"] = suffixed(route.at("end_station_id"), copy);
+                for(auto& stop : route["route_stops"])
+                    stop = suffixed(stop, copy);
+            }
+            scaled["lines"].push_back(std::move(line) );
+        }
+        for(auto travelTime : layout.at("travel_times") ) {
+            travelTime["start_station_id"] = suffixed(travelTime.at("start_station_id"), copy);
+            travelTime["end_station_id"] = suffixed(travelTime.at("end_station_id"), copy);
+            scaled["travel_times"].push_back(std::move(travelTime) );
+        }
+    }
+
+    const auto& stations = layout.at("stations");
+    for(std::size_t copy=0; copy+1<copies; ++copy) {
+        nlohmann::json line{
+            {"line_id", "connector_" + std::to_string(copy)},
+            {"name", "Connector " + std::to_string(copy)},
+            {"routes", nlohmann::json::array()},
+        };
+        for(std::size_t i=0; i<stations.size(); i+=connectorStride) {
+            const auto here = suffixed(stations[i].at("station_id"), copy);
+            const auto there = suffixed(stations[i].at("station_id"), copy + 1);
+            const auto routeId = line["line_id"].get<std::string>() + "_" + std::to_string(i);
+            line["routes"].push_back({
+                {"route_id", routeId + "_out"},
+                {"direction", "outbound"},
+                {"start_station_id", here},
+                {"end_station_id", there},
+                {"route_stops", {here, there}},
+            });
+            line["routes"].push_back({
+                {"route_id", routeId + "_in"},
+                {"direction", "inbound"},
+                {"start_station_id", there},
+                {"end_station_id", here},
+                {"route_stops", {there, here}},
+            });
+            scaled["travel_times"].push_back({
+                {"start_station_id", here},
+                {"end_station_id", there},
+                {"travel_time", 5},
+            });
+        }
+        scaled["lines"].push_back(std::move(line) );
+    }
+    return scaled;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t copies = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    const std::size_t queries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+
+    const auto layout = NetworkMonitor::parseJsonFile(TEST_NETWORK_LAYOUT);
+    if(layout.is_discarded() ) {
+        std::cerr << "Unable to parse " << TEST_NETWORK_LAYOUT << std::endl;
+        return EXIT_FAILURE;
+    }
+    const auto scaled = scaleLayout(layout, copies, 25);
+    std::cout << "Network layout scaled " << copies << "x: "
+              << scaled.at("stations").size() << " stations, "
+              << scaled.at("lines").size() << " lines" << std::endl;
+
+    // Both loaders start from the serialised layout, as they would from a file.
+    const std::string serialised = scaled.dump();
+    TransportNetwork nw{};
+    measure("parse + fromJson", 3, [&](std::size_t) {
+        doNotOptimise(nw.fromJson(nlohmann::json::parse(serialised) ) );
+    });
+    measure("fromJsonStream", 3, [&](std::size_t) {
+        std::istringstream stream{serialised};
+        doNotOptimise(nw.fromJsonStream(stream) );
+    });
+
+    const auto snapshotPath = std::filesystem::temp_directory_path() / "bench-transport_network.snapshot";
+    measure("saveSnapshot", 3, [&](std::size_t) {
+        doNotOptimise(nw.saveSnapshot(snapshotPath) );
+    });
+    measure("loadSnapshot", 3, [&](std::size_t) {
+        doNotOptimise(nw.loadSnapshot(snapshotPath) );
+    });
+    std::cout << "Snapshot: " << std::filesystem::file_size(snapshotPath) << " bytes, JSON: "
+              << serialised.size() << " bytes" << std::endl;
+    std::filesystem::remove(snapshotPath);
+
+    std::vector<Id> stationIds;
+    for(const auto& station : scaled.at("stations") )
+        stationIds.push_back(station.at("station_id") );
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<std::size_t> pick{0, stationIds.size() - 1};
+    std::vector<std::pair<Id, Id> > pairs;
+    for(std::size_t i=0; i<queries; ++i)
+        pairs.emplace_back(stationIds[pick(rng)], stationIds[pick(rng)]);
+
+    std::size_t found = 0;
+    measure("findFastestJourney (no penalty)", queries, [&](std::size_t i) {
+        const auto legs = nw.findFastestJourney(pairs[i].first, pairs[i].second);
+        found += !legs.empty();
+        doNotOptimise(legs.data() );
+    });
+    measure("findFastestJourney (penalty 5)", queries, [&](std::size_t i) {
+        const auto legs = nw.findFastestJourney(pairs[i].first, pairs[i].second, 5);
+        doNotOptimise(legs.data() );
+    });
+    std::cout << found << "/" << queries << " journeys found" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+#include "../benchmark.hpp"
+#include "../../tests/network_monitor/loopback_server.hpp"
+
+#include <network_monitor/websocket_client.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using NetworkMonitor::Benchmark::report;
+using NetworkMonitor::BoostWebSocketClient;
+using NetworkMonitor::LoopbackServer;
+using NetworkMonitor::LoopbackSession;
+
+namespace {
+
+/*  Send `count` messages of `size` bytes to the echo server, keeping up to `window` of them
+ *  in flight, and time until the last echo comes back.
+ *  A window of 1 is a request/response exchange; a larger one lets the write queue fill up.
+ */
+void echoThroughput(unsigned short port, std::size_t count, std::size_t size, std::size_t window) {
+    boost::asio::io_context ioc{};
+    boost::asio::ssl::context ctx{boost::asio::ssl::context::tlsv12_client};
+    BoostWebSocketClient client{"127.0.0.1", "/", std::to_string(port), ioc, ctx};
+
+    const std::string message(size, 'x');
+    std::size_t sent = 0;
+    std::size_t received = 0;
+    std::chrono::steady_clock::time_point start{};
+    std::chrono::steady_clock::time_point end{};
+
+    const auto sendOne = [&]() {
+        ++sent;
+        client.send(message);
+    };
+    const auto onConnect = [&](auto ec) {
+        if(ec) {
+            std::cerr << "Could not connect to the loopback server: " << ec.message() << std::endl;
+            return;
+        }
+        start = std::chrono::steady_clock::now();
+        while(sent < count && sent < window)
+            sendOne();
+    };
+    const auto onMessage = [&](auto ec, std::string&& echo) {
+        if(++received == count) {
+            end = std::chrono::steady_clock::now();
+            client.close();
+            return;
+        }
+        if(sent < count)
+            sendOne();
+    };
+    client.connect(onConnect, onMessage);
+    ioc.run();
+    if(received != count) {
+        std::cerr << "Only " << received << " of " << count << " echoes received" << std::endl;
+        return;
+    }
+
+    const std::chrono::duration<double, std::nano> elapsed = end - start;
+    const double nsPerMessage = elapsed.count() / static_cast<double>(count);
+    report(std::to_string(size) + " B, window " + std::to_string(window), nsPerMessage);
+    std::cout << std::setw(40) << "" << std::setw(14) << std::setprecision(1)
+              << static_cast<double>(size) * 1e3 / nsPerMessage << " MB/s each way" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+
+    // The server runs on its own thread, as a remote broker would.
+    boost::asio::io_context serverIoc{};
+    LoopbackServer server{serverIoc, [](LoopbackSession& session, std::string&& message) {
+        session.send(std::move(message) );
+    }};
+    auto work = boost::asio::make_work_guard(serverIoc);
+    std::thread serverThread{[&serverIoc]() {
+        serverIoc.run();
+    }};
+
+    std::cout << "Echo over TLS on 127.0.0.1:" << server.port() << ", " << count << " messages" << std::endl;
+    for(const std::size_t size : {64, 1024}) {
+        for(const std::size_t window : {1, 16, 256}) {
+            // Request/response exchanges are slow: fewer of them are enough.
+            echoThroughput(server.port(), window == 1 ? count / 10 : count, size, window);
+        }
+    }
+
+    work.reset();
+    serverIoc.stop();
+    serverThread.join();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+#include "../benchmark.hpp"
+#include "../../tests/network_monitor/loopback_server.hpp"
+#include "../passenger_events.hpp"
+
+#include <network_monitor/file_downloader.hpp>
+#include <network_monitor/stomp_frame.hpp>
+#include <network_monitor/websocket_client.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::Benchmark::makePassengerEvents;
+using NetworkMonitor::BoostWebSocketClient;
+using NetworkMonitor::LoopbackServer;
+using NetworkMonitor::LoopbackSession;
+using NetworkMonitor::StompCommand;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompHeader;
+using NetworkMonitor::WebSocketCompression;
+
+namespace {
+
+/*  The /passengers feed as the broker sends it: one MESSAGE frame per passenger event.
+ */
+std::vector<std::string> makePassengerCorpus(const nlohmann::json& layout, std::size_t count) {
+    std::vector<std::string> corpus{};
+    corpus.reserve(count);
+    const auto events = makePassengerEvents(layout, count);
+    for(std::size_t i=0; i<count; ++i) {
+        StompError error;
+        const StompFrame frame {
+            error,
+            StompCommand::Message,
+            {
+                {StompHeader::Subscription, "1"},
+                {StompHeader::MessageId, std::to_string(i)},
+                {StompHeader::Destination, "/passengers"},
+                {StompHeader::ContentLength, std::to_string(events[i].size() )},
+                {StompHeader::ContentType, "application/json"},
+            },
+            events[i]
+        };
+        if(error != StompError::Ok)
+            throw std::runtime_error("Invalid benchmark frame");
+        corpus.push_back(frame.toString() );
+    }
+    return corpus;
+}
+
+/*  Have a loopback broker push the corpus to a client with the given compression, and print
+ *  the bytes on the wire and the CPU time per message. The server compresses with the same
+ *  levels as the client; the window and context takeover are negotiated from the client offer.
+ *  Note that Beast ends each compressed message with a full flush, which drops the history: a
+ *  Beast server gains nothing from context takeover, unlike brokers built on zlib sync flushes.
+ */
+void pushCorpus(std::string_view name, const WebSocketCompression& compression,
+                const std::vector<std::string>& corpus, std::size_t rawBytes)
+{
+    boost::beast::websocket::permessage_deflate deflate{};
+    deflate.server_enable = compression.enabled;
+    deflate.compLevel = compression.level;
+    deflate.memLevel = compression.memLevel;
+
+    boost::asio::io_context serverIoc{};
+    LoopbackServer server{serverIoc, [&corpus](LoopbackSession& session, std::string&&) {
+        for(const auto& frame : corpus)
+            session.send(frame);
+    }, deflate};
+    auto work = boost::asio::make_work_guard(serverIoc);
+    std::thread serverThread{[&serverIoc]() {
+        serverIoc.run();
+    }};
+
+    boost::asio::io_context ioc{};
+    boost::asio::ssl::context ctx{boost::asio::ssl::context::tlsv12_client};
+    BoostWebSocketClient client{"127.0.0.1", "/", std::to_string(server.port() ), ioc, ctx};
+    if(!client.setCompression(compression) )
+        throw std::invalid_argument("Invalid compression options");
+
+    std::size_t received = 0;
+    std::size_t startBytes = 0;
+    std::clock_t startCpu{};
+    std::clock_t endCpu{};
+    std::chrono::steady_clock::time_point start{};
+    std::chrono::steady_clock::time_point end{};
+    client.setOnMessageView([&](auto ec, std::string_view message) {
+        if(++received == corpus.size() ) {
+            end = std::chrono::steady_clock::now();
+            endCpu = std::clock();
+            client.close();
+        }
+    });
+    client.connect([&](auto ec) {
+        if(ec) {
+            std::cerr << "Could not connect to the loopback server: " << ec.message() << std::endl;
+            return;
+        }
+        // Leave the handshakes out of the count.
+        startBytes = server.traffic().bytesWritten.load();
+        start = std::chrono::steady_clock::now();
+        startCpu = std::clock();
+        client.send("start");
+    });
+    ioc.run();
+    const std::size_t wireBytes = server.traffic().bytesWritten.load() - startBytes;
+
+    work.reset();
+    serverIoc.stop();
+    serverThread.join();
+    if(received != corpus.size() ) {
+        std::cerr << "Only " << received << " of " << corpus.size() << " messages received" << std::endl;
+        return;
+    }
+
+    // Both ends run in this process: the CPU time covers compressing and decompressing.
+    const double count = static_cast<double>(corpus.size() );
+    const double cpuNs = static_cast<double>(endCpu - startCpu) * 1e9 / CLOCKS_PER_SEC / count;
+    const std::chrono::duration<double, std::nano> elapsed = end - start;
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed
+              << std::setw(10) << std::setprecision(1) << static_cast<double>(wireBytes) / count
+              << std::setw(10) << std::setprecision(2) << static_cast<double>(rawBytes) / wireBytes
+              << std::setw(12) << std::setprecision(0) << cpuNs
+              << std::setw(12) << elapsed.count() / count
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+
+    const auto layout = NetworkMonitor::parseJsonFile(TEST_NETWORK_LAYOUT);
+    if(layout.empty() ) {
+        std::cerr << "Unable to parse " << TEST_NETWORK_LAYOUT << std::endl;
+        return EXIT_FAILURE;
+    }
+    const auto corpus = makePassengerCorpus(layout, count);
+    std::size_t rawBytes = 0;
+    for(const auto& frame : corpus)
+        rawBytes += frame.size();
+    std::cout << count << " passenger frames, " << static_cast<double>(rawBytes) / count
+              << " bytes each on average" << std::endl;
+    std::cout << std::left << std::setw(28) << "" << std::right
+              << std::setw(10) << "B/msg" << std::setw(10) << "ratio"
+              << std::setw(12) << "CPU ns/msg" << std::setw(12) << "wall ns/msg" << std::endl;
+
+    pushCorpus("off", {}, corpus, rawBytes);
+    pushCorpus("default (15 bits, level 8)", {true}, corpus, rawBytes);
+    pushCorpus("level 1", {true, 15, 4, 1}, corpus, rawBytes);
+    pushCorpus("level 9, memLevel 9", {true, 15, 9, 9}, corpus, rawBytes);
+    pushCorpus("9 window bits", {true, 9}, corpus, rawBytes);
+    pushCorpus("no context takeover", {true, 15, 4, 8, true}, corpus, rawBytes);
+    return EXIT_SUCCESS;
+}
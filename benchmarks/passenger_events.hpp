@@ -0,0 +1,44 @@
+#ifndef HPP_NETWORKMONITOR_PASSENGEREVENTS_
+#define HPP_NETWORKMONITOR_PASSENGEREVENTS_
+
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace NetworkMonitor::Benchmark {
+
+/*! \brief Passenger events as the /passengers feed sends them, at the stations of a network
+ *         layout, one second apart every thousand events.
+ *
+ *  \returns The JSON bodies of the MESSAGE frames. The same layout and count always give the
+ *           same events.
+ */
+inline std::vector<std::string> makePassengerEvents(const nlohmann::json& layout, std::size_t count) {
+    std::vector<std::string> stationIds{};
+    for(const auto& station : layout.at("stations") )
+        stationIds.push_back(station.at("station_id").get<std::string>() );
+
+    std::minstd_rand random{42};
+    std::uniform_int_distribution<std::size_t> pickStation{0, stationIds.size() - 1};
+    std::vector<std::string> events{};
+    events.reserve(count);
+    for(std::size_t i=0; i<count; ++i) {
+        char datetime[32];
+        std::snprintf(datetime, sizeof(datetime), "2020-11-01T07:%02zu:%02zu.%03zu000Z",
+                      i / 60000 % 60, i / 1000 % 60, i % 1000);
+        events.push_back(
+            R"({"datetime":")" + std::string(datetime)
+            + R"(","passenger_event":")" + (random() % 2 == 0 ? "in" : "out")
+            + R"(","station_id":")" + stationIds[pickStation(random)] + R"("})"
+        );
+    }
+    return events;
+}
+
+} // namespace NetworkMonitor::Benchmark
+
+#endif // HPP_NETWORKMONITOR_PASSENGEREVENTS_
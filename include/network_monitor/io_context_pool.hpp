@@ -0,0 +1,82 @@
+#ifndef HPP_NETWORKMONITOR_IOCONTEXTPOOL_
+#define HPP_NETWORKMONITOR_IOCONTEXTPOOL_
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief A set of io_context objects, each run by its own thread.
+ *
+ *  Each connection is given one of the contexts, and so its strand and all its handlers run
+ *  on a single thread. Spreading the connections over the pool lets them use every core, while
+ *  each context stays single-threaded and needs no locking.
+ *
+ *  Contexts are handed out round-robin with next(), or by key with forKey() so that related
+ *  connections share a thread.
+ */
+class IoContextPool {
+public:
+    /*! \brief Create the contexts. The threads are only started by run().
+     *
+     *  \param size       The number of contexts and threads. 0 uses one per hardware thread.
+     *  \param pinThreads Whether to pin the thread of context i to core i, modulo the number of
+     *                    cores. Only supported on Linux; ignored elsewhere.
+     */
+    explicit IoContextPool(size_t size = 0, bool pinThreads = true);
+
+    /*! \brief Stop the contexts and join the threads.
+     */
+    ~IoContextPool();
+
+    IoContextPool(const IoContextPool&) = delete;
+    IoContextPool& operator=(const IoContextPool&) = delete;
+
+    /*! \brief Start one thread per context.
+     *
+     *  The threads keep running, even without work, until stop() is called.
+     */
+    void run();
+
+    /*! \brief Stop the contexts and wait for the threads to finish. Pending handlers are dropped.
+     */
+    void stop();
+
+    /*! \brief The number of contexts.
+     */
+    size_t size() const;
+
+    /*! \brief The next context, in round-robin order. Thread-safe.
+     */
+    boost::asio::io_context& next();
+
+    /*! \brief The context for a key, such as a URL or a subscription. The same key always gets
+     *         the same context.
+     */
+    boost::asio::io_context& forKey(std::string_view key);
+
+    /*! \brief The context at an index lower than size().
+     */
+    boost::asio::io_context& at(size_t index);
+
+private:
+    using WorkGuard = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+    // Contexts cannot be moved, so they are stored behind pointers.
+    std::vector<std::unique_ptr<boost::asio::io_context> > m_contexts{};
+    std::vector<WorkGuard> m_work{};
+    std::vector<std::thread> m_threads{};
+    std::atomic<size_t> m_next{0};
+    bool m_pinThreads{};
+};
+
+} // namespace NetworkMonitor
+
+#endif // HPP_NETWORKMONITOR_IOCONTEXTPOOL_
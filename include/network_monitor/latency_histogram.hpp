@@ -0,0 +1,100 @@
+#ifndef HPP_NETWORKMONITOR_LATENCYHISTOGRAM_
+#define HPP_NETWORKMONITOR_LATENCYHISTOGRAM_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+namespace NetworkMonitor {
+
+/*! \brief Histogram of latencies, safe to record into and to read from any thread.
+ *
+ *  Latencies are counted in microsecond buckets: one per microsecond below 4 µs, then four
+ *  per power of two, so a bucket is at most 25% wider than its lower bound. The last bucket
+ *  also takes everything above about 71 minutes.
+ *
+ *  Recording is lock-free: it only does relaxed atomic additions. Readers may see a record
+ *  in the count before they see it in the buckets.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t bucketCount = 124;
+
+    /*! \brief Add a latency to the histogram.
+     */
+    void record(std::chrono::nanoseconds latency);
+
+    /*! \brief The number of latencies recorded.
+     */
+    uint64_t count() const;
+
+    /*! \brief The mean of the latencies recorded, or 0 if there are none.
+     */
+    std::chrono::nanoseconds mean() const;
+
+    /*! \brief The largest latency recorded.
+     */
+    std::chrono::nanoseconds max() const;
+
+    /*! \brief The latency under which a share of the records fall, as the upper bound of the
+     *         bucket it is in.
+     *
+     *  \param share From 0 to 1, for example 0.99 for the 99th percentile.
+     *
+     *  \returns 0 if there are no records.
+     */
+    std::chrono::nanoseconds percentile(double share) const;
+
+    /*! \brief A copy of the bucket counts, to export them.
+     */
+    std::array<uint64_t, bucketCount> buckets() const;
+
+    /*! \brief The exclusive upper bound of the latencies counted in a bucket.
+     */
+    static std::chrono::microseconds bucketUpperBound(size_t bucket);
+
+    /*! \brief Drop all the records.
+     */
+    void reset();
+
+private:
+    std::array<std::atomic<uint64_t>, bucketCount> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sumNs{0};
+    std::atomic<uint64_t> m_maxNs{0};
+};
+
+/*! \brief Print the count, mean, p50, p90, p99 and maximum of a histogram on one line.
+ */
+void printLatency(std::ostream& os, std::string_view name, const LatencyHistogram& histogram);
+
+/*! \brief Latency of each stage of the connections of a WebSocketClient.
+ */
+struct ConnectionLatency {
+    //! Name resolution. Connections that reuse the cached endpoints skip it.
+    LatencyHistogram resolve{};
+
+    //! TCP connection, from the first attempt until one of the endpoints connects.
+    LatencyHistogram tcpConnect{};
+
+    //! TLS handshake.
+    LatencyHistogram tlsHandshake{};
+
+    //! WebSocket upgrade request and response.
+    LatencyHistogram wsUpgrade{};
+
+    //! From the end of the upgrade until the first message is received.
+    LatencyHistogram firstMessage{};
+};
+
+/*! \brief Print the histogram of each stage, one per line.
+ */
+std::ostream& operator<<(std::ostream& os, const ConnectionLatency& latency);
+
+} // namespace NetworkMonitor
+
+#endif // HPP_NETWORKMONITOR_LATENCYHISTOGRAM_
@@ -0,0 +1,220 @@
+#ifndef HPP_NETWORKMONITOR_LOGGER_
+#define HPP_NETWORKMONITOR_LOGGER_
+
+#include <boost/system/error_code.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*! \brief The lowest level that is compiled in, as the value of a LogLevel.
+ *
+ *  Calls below it compile to nothing. Define it to 0 to keep the debug messages.
+ */
+#ifndef NETWORK_MONITOR_LOG_LEVEL
+#define NETWORK_MONITOR_LOG_LEVEL 1
+#endif
+
+namespace NetworkMonitor {
+
+enum class LogLevel {
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3,
+};
+
+std::ostream& operator<<(std::ostream& os, LogLevel level);
+
+/*! \brief Log argument printing the message of an error code.
+ *
+ *  The message is only looked up when the logger formats it, on its own thread.
+ */
+struct ErrorMessage {
+    boost::system::error_code ec{};
+};
+
+std::ostream& operator<<(std::ostream& os, const ErrorMessage& error);
+
+/*! \brief Logger that never blocks the thread logging a message.
+ *
+ *  The arguments of a message are copied into a slot of a fixed ring buffer, and a background
+ *  thread formats and writes them. Logging does not lock, allocate (except to copy strings) or
+ *  flush: messages logged while the ring buffer is full are dropped and counted.
+ *
+ *  Arguments are formatted with operator<<, on the background thread. They are copied, except
+ *  for character arrays, which are expected to be string literals.
+ */
+class Logger {
+public:
+    /*! \brief Start the background thread.
+     *
+     *  \param sink     Where the messages are written.
+     *  \param capacity Number of slots of the ring buffer, rounded up to a power of 2.
+     */
+    explicit Logger(std::ostream& sink = std::cerr, size_t capacity = 4096);
+
+    /*! \brief Write the pending messages and stop the background thread.
+     */
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /*! \brief The logger of the library, writing to std::cerr.
+     */
+    static Logger& global();
+
+    /*! \brief Queue a message. Thread-safe and lock-free.
+     */
+    template <typename... Args>
+    void log(LogLevel level, const Args&... args);
+
+    /*! \brief Wait until the messages logged so far are written, and flush the sink.
+     */
+    void flush();
+
+    /*! \brief The number of messages dropped because the ring buffer was full.
+     */
+    uint64_t dropped() const;
+
+private:
+    static constexpr size_t argsSize = 192;
+
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        LogLevel level{};
+        std::chrono::system_clock::time_point time{};
+        void (*format)(std::ostream&, void*){nullptr};
+        alignas(std::max_align_t) unsigned char args[argsSize];
+    };
+
+    // String literals are kept as pointers; other strings are copied.
+    template <typename T>
+    using Stored = std::conditional_t<
+        std::is_array_v<T>,
+        const std::remove_extent_t<T>*,
+        std::conditional_t<
+            std::is_same_v<T, const char*> || std::is_same_v<T, char*> || std::is_same_v<T, std::string_view>,
+            std::string,
+            T
+        >
+    >;
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+    std::ostream& m_sink;
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<bool> m_running{true};
+    std::thread m_thread;
+
+    // Background thread: format and write the messages until stopped.
+    void run();
+
+    // Write the messages in the ring buffer. Returns false if there were none.
+    bool drain(std::ostringstream& batch);
+};
+
+template <typename... Args>
+void Logger::log(LogLevel level, const Args&... args)
+{
+    using Tuple = std::tuple<Stored<Args>...>;
+    static_assert(sizeof(Tuple) <= argsSize, "Too many log arguments for a slot");
+    static_assert(alignof(Tuple) <= alignof(std::max_align_t), "Over-aligned log arguments");
+
+    // Claim a slot, as in Dmitry Vyukov's bounded MPMC queue.
+    size_t pos = m_head.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for(;;) {
+        slot = &m_slots[pos & m_mask];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+        if(diff == 0) {
+            if(m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+                break;
+        }
+        else if(diff < 0) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else {
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->time = std::chrono::system_clock::now();
+    new (slot->args) Tuple{args...};
+    // Formats, then destroys, the arguments.
+    slot->format = [](std::ostream& os, void* stored) {
+        auto* tuple = std::launder(reinterpret_cast<Tuple*>(stored) );
+        std::apply([&os](const auto&... arg) {
+            (os << ... << arg);
+        }, *tuple);
+        tuple->~Tuple();
+    };
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+namespace Detail {
+
+constexpr bool isLogged(LogLevel level)
+{
+    return static_cast<int>(level) >= NETWORK_MONITOR_LOG_LEVEL;
+}
+
+} // namespace Detail
+
+/*! \brief Log a debug message to the global logger, if compiled in.
+ */
+template <typename... Args>
+void logDebug(const Args&... args)
+{
+    if constexpr(Detail::isLogged(LogLevel::Debug) )
+        Logger::global().log(LogLevel::Debug, args...);
+}
+
+/*! \brief Log an informative message to the global logger, if compiled in.
+ */
+template <typename... Args>
+void logInfo(const Args&... args)
+{
+    if constexpr(Detail::isLogged(LogLevel::Info) )
+        Logger::global().log(LogLevel::Info, args...);
+}
+
+/*! \brief Log a warning to the global logger, if compiled in.
+ */
+template <typename... Args>
+void logWarning(const Args&... args)
+{
+    if constexpr(Detail::isLogged(LogLevel::Warning) )
+        Logger::global().log(LogLevel::Warning, args...);
+}
+
+/*! \brief Log an error to the global logger, if compiled in.
+ */
+template <typename... Args>
+void logError(const Args&... args)
+{
+    if constexpr(Detail::isLogged(LogLevel::Error) )
+        Logger::global().log(LogLevel::Error, args...);
+}
+
+} // namespace NetworkMonitor
+
+#endif // HPP_NETWORKMONITOR_LOGGER_
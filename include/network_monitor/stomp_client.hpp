@@ -2,14 +2,23 @@
 #define HPP_NETWORKMONITOR_STOMPCLIENT_
 
 #include <network_monitor/stomp_frame.hpp>
+#include <network_monitor/stomp_stream_parser.hpp>
 #include <network_monitor/websocket_client.hpp>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ssl/context.hpp>
+#include <boost/asio/steady_timer.hpp>
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <iostream>
+#include <functional>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace NetworkMonitor {
 
@@ -26,6 +35,7 @@ enum class StompClientError : unsigned {
     UnexpectedCouldNotCreateValidFrame,
     UnexpectedMessageContentType,
     UnexpectedSubscriptionMismatch,
+    HeartBeatTimeout,
     WebSocketServerDisconnected,
 };
 
@@ -51,6 +61,8 @@ inline std::ostream& operator<<(std::ostream& os, StompClientError err) {
         return os<<"UnexpectedMessageContentType"<<std::endl;
     case StompClientError::UnexpectedSubscriptionMismatch:
         return os<<"UnexpectedSubscriptionMismatch"<<std::endl;
+    case StompClientError::HeartBeatTimeout:
+        return os<<"HeartBeatTimeout"<<std::endl;
     case StompClientError::WebSocketServerDisconnected:
         return os<<"WebSocketServerDisconnected"<<std::endl;
     }
@@ -87,13 +99,68 @@ public:
         boost::asio::ssl::context& ctx
     ) :
         m_client{url, endpoint, port, ioc, ctx},
-        m_url{url}
+        m_url{url},
+        m_reconnectTimer{m_client.getExecutor()},
+        m_sendTimer{m_client.getExecutor()},
+        m_receiveTimer{m_client.getExecutor()}
     {
     }
 
     // ...
 
+    /*! \brief Set the heart-beats offered when connecting. Zero disables a direction.
+     *
+     *  The intervals used are negotiated with the server, as in the STOMP v1.2 heart-beat header.
+     *  EOLs are then sent at the outgoing interval. If nothing is received for twice the incoming
+     *  interval, the connection is considered dead: it is closed, then onDisconnect is called.
+     *
+     *  \param send    How often the client can send heart-beats.
+     *  \param receive How often the client wants to receive heart-beats.
+     */
+    void setHeartBeat(std::chrono::milliseconds send, std::chrono::milliseconds receive)
+    {
+        m_heartBeatSend = send;
+        m_heartBeatReceive = receive;
+    }
+
+    /*! \brief Reconnect automatically when an established connection drops.
+     *
+     *  The credentials and the active subscriptions are remembered. Attempts are spaced by a
+     *  jittered exponential backoff: the n-th attempt waits between half and all of
+     *  min(maxDelay, initialDelay * 2^n). Once connected again, the subscriptions are issued
+     *  again with the same IDs and handlers, and onConnect is not called a second time.
+     *  The WebSocket client reuses its TLS context and the endpoints it resolved.
+     *
+     *  \param initialDelay Delay before the first attempt. Zero disables reconnection, the default.
+     *  \param maxDelay     Upper bound of the delay between attempts.
+     *  \param maxAttempts  Consecutive failed attempts after which onDisconnect is called.
+     *                      Zero retries forever.
+     */
+    void setReconnect(
+        std::chrono::milliseconds initialDelay,
+        std::chrono::milliseconds maxDelay,
+        unsigned maxAttempts = 0
+    )
+    {
+        m_reconnectInitialDelay = initialDelay;
+        m_reconnectMaxDelay = std::max(initialDelay, maxDelay);
+        m_reconnectMaxAttempts = maxAttempts;
+    }
+
+    /*! \brief Set the WebSocket compression offered on the next connection.
+     *
+     *  \returns false, keeping the previous options, if one of them is out of range.
+     */
+    bool setCompression(const WebSocketCompression& compression)
+    {
+        return m_client.setCompression(compression);
+    }
+
     /*! \brief Connect to the STOMP server.
+     *
+     *  \param onConnect    Called once the first connection succeeds or fails.
+     *  \param onDisconnect Called when the connection drops, or with reconnection enabled,
+     *                      when the client gives up reconnecting.
      */
     void connect(
         const std::string& username,
@@ -102,67 +169,14 @@ public:
         std::function<void(StompClientError)> onDisconnect = [](auto&&...){}
     )
     {
-        onConnect = onConnect ? onConnect : [](auto&&...){};
-        onDisconnect = onDisconnect ? onDisconnect : [](auto&&...){};
-        const auto stompConnect = [this,onConnect, username, password](error_code ec){
-            if(ec) {
-                std::cerr<<"stomp connect;"<<__LINE__<<": "<<ec<<std::endl;
-                onConnect(StompClientError::CouldNotConnectToWebSocketServer);
-                return;
-            }
-            StompError ferr;
-            const StompFrame frame{
-                ferr,
-                StompCommand::Stomp,
-                {
-                    {StompHeader::AcceptVersion, "1.2"},
-                    {StompHeader::Host, m_url},
-                    {StompHeader::Login, username},
-                    {StompHeader::Passcode, password},
-                }
-            };
-            if(ferr != StompError::Ok) {
-                std::cerr<<"stomp connect;"<<__LINE__<<": "<<ferr<<std::endl;
-                onConnect(StompClientError::UnexpectedCouldNotCreateValidFrame);
-                return;
-            }
-            m_client.send(frame.toString(), [onConnect](error_code ec){
-                if(ec) {
-                    std::cerr<<"stomp connect.send;"<<__LINE__<<": "<<ec<<std::endl;
-                    onConnect(StompClientError::CouldNotSendStompFrame);
-                    return;
-                }
-            });
-        };
-        const auto stompMessage = [this, onConnect, onDisconnect](error_code ec, std::string&& msg){
-            if(ec) {
-                std::cerr<<"stomp message;"<<__LINE__<<": "<<ec<<std::endl;
-                return;
-            }
-            StompError ferr;
-            StompFrame frame{ferr, std::move(msg)};
-            if(ferr != StompError::Ok) {
-                std::cerr<<"stomp Message;"<<__LINE__<<": "<<ferr<<std::endl;
-                m_onMessage(StompClientError::CouldNotParseMessageAsStompFrame, "");
-                return;
-            }
-            if(frame.getCommand() == StompCommand::Error) {
-                onDisconnect(StompClientError::WebSocketServerDisconnected);
-                return;
-            }
-
-            if(m_onMessage) {
-                m_onMessage(StompClientError::Ok, frame.toString() );
-                return;
-            } else {
-                if(frame.getCommand() != StompCommand::Connected) {
-                    onDisconnect(StompClientError::WebSocketServerDisconnected);
-                    return;
-                }
-                onConnect(StompClientError::Ok);
-            }
-        };
-        m_client.connect(stompConnect, stompMessage);
+        m_username = username;
+        m_password = password;
+        m_onConnect = onConnect ? onConnect : [](auto&&...){};
+        m_onDisconnect = onDisconnect ? onDisconnect : [](auto&&...){};
+        m_closing = false;
+        m_sessionEstablished = false;
+        m_reconnectAttempt = 0;
+        connectWebSocket();
     }
 
     /*! \brief Close the STOMP and WebSocket connection.
@@ -170,6 +184,9 @@ public:
     void close(std::function<void(StompClientError)> onClose = [](auto&&...){} )
     {
         onClose = onClose ? onClose : [](auto&&...){};
+        m_closing = true;
+        m_reconnectTimer.cancel();
+        stopHeartBeat();
         StompError ferr;
         StompFrame frame{
             ferr,
@@ -182,13 +199,13 @@ public:
         }
         m_client.send(frame.toString(), [this, onClose](error_code ec){
             if(ec) {
-                std::cerr<<"stomp close.send;"<<__LINE__<<": "<<ec.message()<<std::endl;
+                logError("stomp close.send;", __LINE__, ": ", ErrorMessage{ec});
                 onClose(StompClientError::CouldNotCloseWebSocketConnection);
                 return;
             }
             m_client.close([onClose](error_code ec){
                 if(ec) {
-                    std::cerr<<"stomp close.close;"<<__LINE__<<": "<<ec.message()<<std::endl;
+                    logError("stomp close.close;", __LINE__, ": ", ErrorMessage{ec});
                     onClose(StompClientError::CouldNotCloseWebSocketConnection);
                     return;
                 }
@@ -198,6 +215,12 @@ public:
     }
 
     /*! \brief Subscribe to a STOMP endpoint.
+     *
+     *  Several subscriptions can be active on the same connection. Each MESSAGE frame is routed
+     *  to the handler of the subscription it belongs to.
+     *
+     *  \param onSubscribe Called with the subscription ID once the server acknowledged it.
+     *  \param onMessage   Called with each message of this subscription, as a serialised frame.
      *
      *  \returns The subscription ID.
      */
@@ -206,14 +229,283 @@ public:
         std::function<void(StompClientError, std::string&&)> onSubscribe,
         std::function<void(StompClientError, std::string&&)> onMessage
     )
+    {
+        onMessage = onMessage ? onMessage : [](auto&&...){};
+        return subscribeFrames(destination, onSubscribe, [onMessage](StompClientError ec, const StompFrame& frame) {
+            onMessage(ec, ec == StompClientError::Ok ? frame.toString() : "");
+        });
+    }
+
+    /*! \brief Subscribe to a STOMP endpoint, receiving the parsed frames.
+     *
+     *  Like subscribe(), but the handler gets the parsed MESSAGE frame instead of a copy of the
+     *  serialised one, so the body and headers are read without parsing the message again.
+     *
+     *  \param onMessage Called with each message of this subscription. The frame is only valid
+     *                   during the call, and only when the error is StompClientError::Ok.
+     *                   It is also called with an error if the subscription could not be issued
+     *                   again after a reconnection.
+     *
+     *  \returns The subscription ID.
+     */
+    std::string subscribeFrames(
+        const std::string& destination,
+        std::function<void(StompClientError, std::string&&)> onSubscribe,
+        std::function<void(StompClientError, const StompFrame&)> onMessage
+    )
     {
         onSubscribe = onSubscribe ? onSubscribe : [](auto&&...){};
         onMessage = onMessage ? onMessage : [](auto&&...){};
-        const auto subId = std::to_string(++s_sub);
-        m_onMessage = [this, onSubscribe, onMessage, subId](StompClientError err, std::string&& msg) {
+        const auto subId = std::to_string(++m_subscriptionCounter);
+        m_subscriptions[subId] = {destination, onMessage};
+        m_onReceipt[subId] = [onSubscribe, subId]() {
             onSubscribe(StompClientError::Ok, std::string(subId) );
-            m_onMessage = onMessage;
         };
+        const auto ec = sendSubscribe(destination, subId, [this, onSubscribe, subId](error_code ec){
+            if(ec) {
+                logError("stomp subscribe.send;", __LINE__, ": ", ec);
+                m_subscriptions.erase(subId);
+                m_onReceipt.erase(subId);
+                onSubscribe(StompClientError::CouldNotSendSubscribeFrame, "");
+                return;
+            }
+        });
+        if(ec != StompClientError::Ok) {
+            m_subscriptions.erase(subId);
+            m_onReceipt.erase(subId);
+            onSubscribe(ec, "");
+            return "";
+        }
+        return subId;
+    }
+
+private:
+    struct Subscription {
+        std::string destination{};
+        std::function<void(StompClientError, const StompFrame&)> onMessage{};
+    };
+
+    WsClient m_client;
+    std::string m_url{};
+    StompStreamParser m_parser{};
+
+    std::string m_username{};
+    std::string m_password{};
+    std::function<void(StompClientError)> m_onConnect{};
+    std::function<void(StompClientError)> m_onDisconnect{};
+    // Set by close(), so that the end of the connection is neither reported nor recovered.
+    bool m_closing = false;
+    // Whether a CONNECTED frame has been received since connect().
+    bool m_sessionEstablished = false;
+    // Whether the loss of the current connection has been handled already.
+    bool m_connectionLost = false;
+
+    std::chrono::milliseconds m_reconnectInitialDelay{0};
+    std::chrono::milliseconds m_reconnectMaxDelay{0};
+    unsigned m_reconnectMaxAttempts = 0;
+    unsigned m_reconnectAttempt = 0;
+    StompClientError m_lostReason = StompClientError::Ok;
+    boost::asio::steady_timer m_reconnectTimer;
+    std::minstd_rand m_random{std::random_device{}()};
+
+    std::chrono::milliseconds m_heartBeatSend{10000};
+    std::chrono::milliseconds m_heartBeatReceive{10000};
+    boost::asio::steady_timer m_sendTimer;
+    boost::asio::steady_timer m_receiveTimer;
+    std::chrono::steady_clock::time_point m_lastReceived{};
+
+    unsigned m_subscriptionCounter = 0;
+    // Keyed by subscription ID.
+    std::unordered_map<std::string, Subscription> m_subscriptions{};
+    // Keyed by receipt ID.
+    std::unordered_map<std::string, std::function<void()> > m_onReceipt{};
+
+    // Open the WebSocket connection and start the STOMP session, for connect() and each reconnection.
+    void connectWebSocket()
+    {
+        m_connectionLost = false;
+        const auto stompConnect = [this](error_code ec){
+            if(ec) {
+                logError("stomp connect;", __LINE__, ": ", ec);
+                onConnectFailed(StompClientError::CouldNotConnectToWebSocketServer);
+                return;
+            }
+            StompError ferr;
+            const StompFrame frame{
+                ferr,
+                StompCommand::Stomp,
+                {
+                    {StompHeader::AcceptVersion, "1.2"},
+                    {StompHeader::Host, m_url},
+                    {StompHeader::Login, m_username},
+                    {StompHeader::Passcode, m_password},
+                    {StompHeader::HeartBeat, std::to_string(m_heartBeatSend.count() ) + ","
+                                             + std::to_string(m_heartBeatReceive.count() )},
+                }
+            };
+            if(ferr != StompError::Ok) {
+                logError("stomp connect;", __LINE__, ": ", ferr);
+                onConnectFailed(StompClientError::UnexpectedCouldNotCreateValidFrame);
+                return;
+            }
+            m_client.send(frame.toString(), [this](error_code ec){
+                if(ec) {
+                    logError("stomp connect.send;", __LINE__, ": ", ec);
+                    onConnectFailed(StompClientError::CouldNotSendStompFrame);
+                    return;
+                }
+            });
+        };
+        const auto stompFrame = [this](StompError ferr, StompFrame&& frame){
+            if(ferr != StompError::Ok) {
+                logError("stomp Message;", __LINE__, ": ", ferr);
+                notifyParsingError(frame);
+                return;
+            }
+            switch(frame.getCommand() ) {
+            case StompCommand::Connected:
+                startHeartBeat(frame);
+                m_reconnectAttempt = 0;
+                if(m_sessionEstablished) {
+                    resubscribe();
+                } else {
+                    m_sessionEstablished = true;
+                    m_onConnect(StompClientError::Ok);
+                }
+            break;
+            case StompCommand::Error:
+                onConnectionLost(StompClientError::WebSocketServerDisconnected);
+            break;
+            case StompCommand::Receipt:
+                onReceipt(frame);
+            break;
+            case StompCommand::Message:
+                onMessage(frame);
+            break;
+            default:
+                logError("stomp Message;", __LINE__, ": unexpected frame ", frame.getCommand());
+            break;
+            }
+        };
+        // A WebSocket message can hold several frames, or only part of one.
+        m_parser = StompStreamParser{stompFrame};
+        const auto stompMessage = [this](error_code ec, std::string&& msg){
+            if(ec) {
+                logError("stomp message;", __LINE__, ": ", ec);
+                return;
+            }
+            // Any data, heart-beats included, shows the connection is alive.
+            m_lastReceived = std::chrono::steady_clock::now();
+            if(m_parser.push(std::move(msg) ) != StompError::Ok) {
+                logError("stomp Message;", __LINE__, ": frame too large");
+                StompError ferr;
+                notifyParsingError(StompFrame{ferr, std::string{}});
+            }
+        };
+        const auto stompDisconnect = [this](error_code ec){
+            logWarning("stomp disconnect;", __LINE__, ": ", ec);
+            onConnectionLost(StompClientError::WebSocketServerDisconnected);
+        };
+        m_client.connect(stompConnect, stompMessage, stompDisconnect);
+    }
+
+    void onConnectFailed(StompClientError ec)
+    {
+        if(m_sessionEstablished) {
+            // A reconnection attempt failed.
+            onConnectionLost(ec);
+            return;
+        }
+        m_onConnect(ec);
+    }
+
+    // Report the end of the connection once, or try to recover it.
+    void onConnectionLost(StompClientError ec)
+    {
+        if(m_closing || m_connectionLost)
+            return;
+        m_connectionLost = true;
+        stopHeartBeat();
+        // After a heart-beat timeout or an ERROR frame, the WebSocket connection is still open.
+        // It is closed first, as the next connection can only start once its operations are over.
+        m_client.close([this, ec](error_code closeEc) {
+            if(closeEc && closeEc != boost::asio::error::operation_aborted)
+                logWarning("stomp connectionLost.close;", __LINE__, ": ", ErrorMessage{closeEc});
+            if(m_closing)
+                return;
+            if(m_sessionEstablished && m_reconnectInitialDelay.count() != 0) {
+                m_lostReason = ec;
+                scheduleReconnect();
+                return;
+            }
+            m_onDisconnect(ec);
+        });
+    }
+
+    void scheduleReconnect()
+    {
+        if(m_reconnectMaxAttempts != 0 && m_reconnectAttempt >= m_reconnectMaxAttempts) {
+            logWarning("stomp reconnect;", __LINE__, ": giving up after ", m_reconnectAttempt, " attempts");
+            m_onDisconnect(m_lostReason);
+            return;
+        }
+        // Jitter spreads out the clients reconnecting to the same broker after a failover.
+        const auto ceiling = std::min<std::chrono::milliseconds>(
+            m_reconnectMaxDelay,
+            m_reconnectInitialDelay * (1 << std::min(m_reconnectAttempt, 20u) )
+        );
+        std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter{ceiling.count() / 2, ceiling.count()};
+        ++m_reconnectAttempt;
+        m_reconnectTimer.expires_after(std::chrono::milliseconds{jitter(m_random)});
+        m_reconnectTimer.async_wait([this](error_code ec) {
+            if(ec || m_closing)
+                return;
+            connectWebSocket();
+        });
+    }
+
+    // Issue the active subscriptions again on a new connection, with their original IDs.
+    // A subscription that could not be issued again is reported to its message handler.
+    void resubscribe()
+    {
+        // The handlers may subscribe again, so they are not called while iterating the table.
+        std::vector<std::pair<std::string, StompClientError> > failed{};
+        for(const auto& [subId, subscription] : m_subscriptions) {
+            // A subscription still waiting for its first receipt keeps its onSubscribe handler.
+            m_onReceipt.try_emplace(subId, [subId = subId]() {
+                logInfo("stomp resubscribe;", __LINE__, ": ", subId, ": subscribed again");
+            });
+            const auto ec = sendSubscribe(subscription.destination, subId, [this, subId = subId](error_code ec){
+                if(ec) {
+                    logError("stomp resubscribe.send;", __LINE__, ": ", subId, ": ", ec);
+                    onResubscribeFailed(subId, StompClientError::CouldNotSendSubscribeFrame);
+                }
+            });
+            if(ec != StompClientError::Ok) {
+                logError("stomp resubscribe;", __LINE__, ": ", subId, ": ", ec);
+                failed.emplace_back(subId, ec);
+            }
+        }
+        for(const auto& [subId, ec] : failed)
+            onResubscribeFailed(subId, ec);
+    }
+
+    void onResubscribeFailed(const std::string& subId, StompClientError ec)
+    {
+        m_onReceipt.erase(subId);
+        const auto iter = m_subscriptions.find(subId);
+        if(iter == m_subscriptions.end() )
+            return;
+        StompError ferr;
+        iter->second.onMessage(ec, StompFrame{ferr, std::string{}});
+    }
+
+    StompClientError sendSubscribe(
+        const std::string& destination,
+        const std::string& subId,
+        std::function<void(error_code)> onSend
+    )
+    {
         StompError ferr;
         const StompFrame frame{
             ferr,
@@ -225,27 +517,109 @@ public:
                 {StompHeader::Ack, "auto"},
             },
         };
-        if(ferr != StompError::Ok) {
-            onSubscribe(StompClientError::UnexpectedCouldNotCreateValidFrame, "");
-            return "";
+        if(ferr != StompError::Ok)
+            return StompClientError::UnexpectedCouldNotCreateValidFrame;
+        m_client.send(frame.toString(), onSend);
+        return StompClientError::Ok;
+    }
+
+    /*  Negotiate the heart-beat intervals with the CONNECTED frame, and start the timers.
+     *  The timers run on the strand of the WebSocket client, like every other handler.
+     */
+    void startHeartBeat(const StompFrame& connected)
+    {
+        unsigned long serverSend = 0;
+        unsigned long serverReceive = 0;
+        if(connected.hasHeader(StompHeader::HeartBeat) ) {
+            const auto value = connected.getHeader(StompHeader::HeartBeat);
+            const auto comma = value.find(',');
+            if(comma != std::string_view::npos) {
+                std::from_chars(value.data(), value.data() + comma, serverSend);
+                std::from_chars(value.data() + comma + 1, value.data() + value.size(), serverReceive);
+            }
         }
-        m_client.send(frame.toString(), [this, onSubscribe, onMessage, subId](error_code ec){
-            if(ec) {
-                std::cerr<<"stomp subscribe.send;"<<__LINE__<<": "<<ec<<std::endl;
-                onSubscribe(StompClientError::CouldNotSendSubscribeFrame, "");
+        using std::chrono::milliseconds;
+        const auto negotiate = [](milliseconds mine, unsigned long theirs) {
+            return mine.count() == 0 || theirs == 0 ? milliseconds{0} : std::max(mine, milliseconds(theirs) );
+        };
+        const auto sendInterval = negotiate(m_heartBeatSend, serverReceive);
+        const auto receiveInterval = negotiate(m_heartBeatReceive, serverSend);
+        if(sendInterval.count() != 0)
+            scheduleHeartBeat(sendInterval);
+        if(receiveInterval.count() != 0) {
+            m_lastReceived = std::chrono::steady_clock::now();
+            scheduleSilenceCheck(receiveInterval);
+        }
+    }
+
+    void stopHeartBeat()
+    {
+        m_sendTimer.cancel();
+        m_receiveTimer.cancel();
+    }
+
+    void scheduleHeartBeat(std::chrono::milliseconds interval)
+    {
+        m_sendTimer.expires_after(interval);
+        m_sendTimer.async_wait([this, interval](error_code ec) {
+            if(ec)
+                return;
+            m_client.send("\n", [](error_code ec) {
+                if(ec)
+                    logError("stomp heart-beat;", __LINE__, ": ", ec);
+            });
+            scheduleHeartBeat(interval);
+        });
+    }
+
+    void scheduleSilenceCheck(std::chrono::milliseconds interval)
+    {
+        m_receiveTimer.expires_after(interval);
+        m_receiveTimer.async_wait([this, interval](error_code ec) {
+            if(ec)
+                return;
+            // Allow twice the interval, so a heart-beat delayed by the network is not a disconnection.
+            if(std::chrono::steady_clock::now() - m_lastReceived > 2 * interval) {
+                logError("stomp heart-beat;", __LINE__, ": ", StompClientError::HeartBeatTimeout);
+                onConnectionLost(StompClientError::HeartBeatTimeout);
                 return;
             }
+            scheduleSilenceCheck(interval);
         });
-        return subId;
     }
 
-private:
-    inline static unsigned s_sub = 0;
+    void onReceipt(const StompFrame& frame)
+    {
+        const auto iter = m_onReceipt.find(std::string(frame.getHeader(StompHeader::ReceiptId) ) );
+        if(iter == m_onReceipt.end() ) {
+            logWarning("stomp receipt;", __LINE__, ": unknown receipt ", frame.getHeader(StompHeader::ReceiptId));
+            return;
+        }
+        const auto handler = std::move(iter->second);
+        m_onReceipt.erase(iter);
+        handler();
+    }
 
-    WsClient m_client;
-    std::string m_url{};
+    void onMessage(const StompFrame& frame)
+    {
+        const auto iter = m_subscriptions.find(std::string(frame.getHeader(StompHeader::Subscription) ) );
+        if(iter == m_subscriptions.end() ) {
+            logError("stomp message;", __LINE__, ": ", StompClientError::UnexpectedSubscriptionMismatch);
+            return;
+        }
+        iter->second.onMessage(StompClientError::Ok, frame);
+    }
 
-    std::function<void(StompClientError, std::string&&)> m_onMessage = nullptr;
+    // A frame that cannot be parsed could belong to any subscription.
+    void notifyParsingError(const StompFrame& frame)
+    {
+        // The handlers may subscribe again, so they are not called while iterating the table.
+        std::vector<std::function<void(StompClientError, const StompFrame&)> > handlers{};
+        for(const auto& [id, subscription] : m_subscriptions)
+            handlers.push_back(subscription.onMessage);
+        for(const auto& handler : handlers)
+            handler(StompClientError::CouldNotParseMessageAsStompFrame, frame);
+    }
 };
 
 } // namespace NetworkMonitor
@@ -2,12 +2,16 @@
 #ifndef HPP_NETWORKMONITOR_STOMPFRAME_
 #define HPP_NETWORKMONITOR_STOMPFRAME_
 
+#include <boost/beast/core/flat_buffer.hpp>
+
+#include <array>
 #include <cstddef>
 #include <initializer_list>
 #include <iosfwd>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 
 using std::size_t;
 
@@ -39,6 +43,7 @@ enum class StompHeader : unsigned {
     ContentLength,
     ContentType,
     Destination,
+    HeartBeat,
     Host,
     Id,
     Login,
@@ -50,7 +55,7 @@ enum class StompHeader : unsigned {
     Subscription,
     Version,
 };
-constexpr size_t StompHeader_count = 15;
+constexpr size_t StompHeader_count = 16;
 
 std::ostream& operator<<(std::ostream& os, StompHeader sh);
 
@@ -69,6 +74,10 @@ std::ostream& operator<<(std::ostream& os, StompError se);
 // ...
 
 /* \brief STOMP frame representation, supporting STOMP v1.2.
+ *
+ *  The frame owns a single buffer holding the serialised frame. Headers and body are kept as
+ *  slices of that buffer, so parsing a frame does not allocate. Escaped header values are only
+ *  decoded the first time they are requested.
  */
 class StompFrame {
 public:
@@ -95,18 +104,87 @@ public:
 
     StompCommand getCommand() const;
     bool hasHeader(StompHeader sh) const;
+
+    /*! \brief Get the (unescaped) value of a header.
+     *
+     *  The view stays valid for the lifetime of the frame.
+     *  \note Decoding an escaped value is cached, so concurrent calls on the same frame
+     *        must be synchronised by the caller.
+     */
     std::string_view getHeader(StompHeader sh) const;
     std::string_view getBody() const;
     std::string toString() const;
 
+    /*! \brief View of the serialised frame, without copying it.
+     */
+    std::string_view toStringView() const;
+
 private:
+    /* Position of a value inside m_frame (or m_unescaped once decoded).
+     */
+    struct Slice {
+        size_t offset{};
+        size_t length{};
+    };
+
+    enum class HeaderState : unsigned char {
+        Absent,
+        Plain,
+        Escaped,
+        Decoded,
+    };
+
+    struct HeaderSlot {
+        Slice slice{};
+        HeaderState state{HeaderState::Absent};
+    };
+
     std::string m_frame{};
     StompCommand m_command{};
-    std::unordered_map<StompHeader, std::string> m_headerMp{};
-    std::string m_body{};
+    mutable std::array<HeaderSlot, StompHeader_count> m_headers{};
+    Slice m_body{};
+    mutable std::string m_unescaped{};
 
     StompError parseFrame();
-    StompError validation();
+    StompError validation() const;
+    StompError setHeader(StompHeader sh, Slice value);
+    std::string_view view(Slice slice) const;
+};
+
+// ...
+
+/*! \brief Serialise STOMP frames straight into caller-supplied buffers.
+ *
+ *  The frame size is computed first, so the output grows at most once per frame. Frames are
+ *  appended: a connection can keep one buffer, and clear it (or consume it) between writes.
+ */
+class StompFrameWriter {
+public:
+    using Header = std::pair<StompHeader, std::string_view>;
+
+    /*! \brief Size of the serialised frame, header values escaped.
+     */
+    static size_t frameSize(StompCommand sc,
+                            std::initializer_list<Header> headers = {},
+                            std::string_view body = {});
+
+    /*! \brief Append the frame to a string.
+     *
+     *  \returns The result of validating the frame. Nothing is written unless it is StompError::Ok.
+     */
+    static StompError write(std::string& out,
+                            StompCommand sc,
+                            std::initializer_list<Header> headers = {},
+                            std::string_view body = {});
+
+    /*! \brief Append the frame to the readable bytes of a flat_buffer.
+     *
+     *  \returns The result of validating the frame. Nothing is written unless it is StompError::Ok.
+     */
+    static StompError write(boost::beast::flat_buffer& out,
+                            StompCommand sc,
+                            std::initializer_list<Header> headers = {},
+                            std::string_view body = {});
 };
 
 } // namespace NetworkMonitor
@@ -0,0 +1,86 @@
+#ifndef HPP_NETWORKMONITOR_STOMPSTREAMPARSER_
+#define HPP_NETWORKMONITOR_STOMPSTREAMPARSER_
+
+#include <network_monitor/stomp_frame.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace NetworkMonitor {
+
+/*! \brief Incremental parser splitting a stream of bytes into STOMP frames.
+ *
+ *  Bytes are pushed in chunks of any size: a chunk can hold part of a frame, several frames,
+ *  or heart-beat EOLs between frames. Each complete frame is parsed into a StompFrame and
+ *  handed to the callback.
+ *
+ *  Only the incomplete frame at the end of the stream is buffered, up to maxFrameSize bytes.
+ *  A frame with a content-length header is delimited by it, so its body can hold NULL octets.
+ */
+class StompStreamParser {
+public:
+    /*! \brief Called with each complete frame, and the result of parsing it.
+     *
+     *  The callback must not push into or reset the parser that invoked it.
+     */
+    using FrameHandler = std::function<void(StompError, StompFrame&&)>;
+
+    static constexpr size_t defaultMaxFrameSize = 1024 * 1024;
+
+    explicit StompStreamParser(FrameHandler onFrame = nullptr, size_t maxFrameSize = defaultMaxFrameSize);
+
+    /*! \brief Feed the next chunk of the stream to the parser.
+     *
+     *  Invalid frames are still delimited, and handed to the callback with their error.
+     *
+     *  \returns StompError::Parsing if a frame exceeds the maximum frame size, in which case
+     *           the buffered bytes are discarded; StompError::Ok otherwise.
+     */
+    StompError push(std::string_view chunk);
+
+    /*! \brief Feed the next chunk of the stream to the parser, taking ownership of it.
+     *
+     *  A chunk holding exactly one frame is moved into the StompFrame without being copied.
+     */
+    StompError push(std::string&& chunk);
+
+    /*! \brief Discard any partially received frame.
+     */
+    void reset();
+
+    /*! \brief Number of bytes held for the incomplete frame.
+     */
+    size_t bufferedSize() const;
+
+private:
+    enum class State {
+        Idle,
+        Headers,
+        Body,
+    };
+
+    FrameHandler m_onFrame{};
+    size_t m_maxFrameSize{};
+
+    std::string m_buffer{};
+    State m_state{State::Idle};
+    // Offsets in m_buffer of the current frame, of the end of its headers,
+    // of how far it has been scanned, and of the NULL octet announced by content-length.
+    size_t m_frameBegin{};
+    size_t m_headersEnd{};
+    size_t m_scanned{};
+    size_t m_bodyEnd{std::string::npos};
+
+    StompError parse();
+    StompError waitForMore();
+    StompError discard();
+    bool findHeadersEnd();
+    size_t findFrameEnd();
+    void emitFrame(size_t frameEnd);
+};
+
+} // namespace NetworkMonitor
+
+#endif // HPP_NETWORKMONITOR_STOMPSTREAMPARSER_
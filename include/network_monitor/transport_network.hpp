@@ -4,9 +4,16 @@
 
 #include <nlohmann/json_fwd.hpp>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace NetworkMonitor {
@@ -15,6 +22,14 @@ namespace NetworkMonitor {
  */
 using Id = std::string;
 
+/*! \brief Dense index of a station in a TransportNetwork, assigned in insertion order.
+ */
+using StationIndex = std::uint32_t;
+
+/*! \brief Dense index of a route in a TransportNetwork, assigned in insertion order.
+ */
+using RouteIndex = std::uint32_t;
+
 /*! \brief Network station
  *
  *  \note A station struct is well formed if:
@@ -43,7 +58,7 @@ struct Station {
  *      - `startStationId` is the first stop in `stops`.
  *      - `endStationId` is the last stop in `stops`.
  *      - Every `stationId` station in `stops` exists.
- *      - Every stop in `stops` appears only once.
+ *      - A route does not ride the same hop between 2 stops twice.
  */
 struct Route {
     Id id{};
@@ -90,6 +105,22 @@ struct PassengerEvent {
     Type type{};
 };
 
+/*! \brief A leg of a journey, travelled along a single route.
+ */
+struct JourneyLeg {
+    Id lineId{};
+    Id routeId{};
+    Id startStationId{};
+    Id endStationId{};
+    unsigned int travelTime{};
+
+    bool operator==(const JourneyLeg& other) const {
+        return lineId == other.lineId && routeId == other.routeId &&
+               startStationId == other.startStationId && endStationId == other.endStationId &&
+               travelTime == other.travelTime;
+    }
+};
+
 /*! \brief Underground network representation
  */
 class TransportNetwork {
@@ -107,6 +138,49 @@ public:
      */
     bool fromJson(nlohmann::json&& src);
 
+    /*! \brief Populate the network from a JSON stream, without building a JSON object.
+     *
+     *  The network is built straight from the parser events.
+     *  Only the lines and travel times are kept until the end of the stream,
+     *  as they may come before the stations they refer to.
+     *
+     *  \returns false if stations and lines where parsed successfully, but not the travel times.
+     *
+     *  \throws std::runtime_error If an item is missing a field, or there's an issue adding new stations
+     *                             or lines to the network.
+     *
+     *  \throws nlohmann::json::exception If the stream is not valid JSON.
+     */
+    bool fromJsonStream(std::istream& src);
+
+    /*! \brief Populate the network from a JSON file, without building a JSON object.
+     *
+     *  \throws std::runtime_error If the file cannot be opened, see also fromJsonStream.
+     *
+     *  \throws nlohmann::json::exception If the file is not valid JSON.
+     */
+    bool fromJsonFile(const std::filesystem::path& src);
+
+    /*! \brief Save the network layout to a binary snapshot file.
+     *
+     *  The snapshot holds the stations, lines, routes and travel times, but not the passenger counts.
+     *  It is versioned and checksummed, and only uses offsets relative to the start of the file.
+     *  It is written next to dst, then renamed over it, so a failed save keeps the previous file.
+     *
+     *  \returns false if the file could not be written.
+     */
+    bool saveSnapshot(const std::filesystem::path& dst) const;
+
+    /*! \brief Replace the network with the layout from a binary snapshot file.
+     *
+     *  The file is memory-mapped and its arrays are copied in as they are,
+     *  only the ID lookup tables are rebuilt.
+     *
+     *  \returns false if the file is missing, corrupted or from another snapshot version.
+     *           The network is left untouched in that case.
+     */
+    bool loadSnapshot(const std::filesystem::path& src);
+
     /*! \brief Add a station to the network.
      *
      *  \param station - a well-formed station that's not in the network
@@ -119,6 +193,8 @@ public:
      *
      *  \param line - a well-formed station that's not in the network.
      *              - all stations served by this line, must already be in the network.
+     *              - a route can stop at a station more than once, but not ride the same
+     *                hop between 2 stations twice.
      *
      * \returns false if there was an error while adding the station to the network.
      */
@@ -129,9 +205,24 @@ public:
      *  \param event - must correspond to a station already in the network.
      *
      *  \returns false if the passenger event is not recognised.
+     *
+     *  \note This can be called concurrently from several threads, and alongside getPassengerCount,
+     *        but not while stations or lines are being added.
      */
     bool recordPassengerEvent(const PassengerEvent& event);
 
+    /*! \brief Record a batch of passenger events.
+     *
+     *  The events are folded into one count change per station before any counter is touched.
+     *  An unrecognised event does not stop the rest of the batch from being recorded.
+     *
+     *  \returns The positions in `events` of the events that were not recognised,
+     *           in increasing order. Empty if all the events were recorded.
+     *
+     *  \note The same concurrency rules as recordPassengerEvent apply.
+     */
+    std::vector<std::size_t> recordPassengerEvents(const std::vector<PassengerEvent>& events);
+
     /*! \brief Get the number of passenger currently at a station.
      *
      *  \param station - must be a well-formed station already in the network.
@@ -185,20 +276,138 @@ public:
             const Id& stationB
     ) const;
 
+    /*! \brief Find the fastest journey between 2 stations, across all lines.
+     *
+     *  \param lineChangePenalty   The time added to the journey each time it changes line.
+     *                              Changing route within the same line is free.
+     *
+     *  \returns The legs of the journey in travel order,
+     *          an empty vector if both stations are the same, or if there is no journey between them.
+     *
+     *  \note The search buffers are kept per thread and reused across calls.
+     */
+    std::vector<JourneyLeg> findFastestJourney(
+            const Id& from,
+            const Id& to,
+            unsigned int lineChangePenalty = 0
+    ) const;
+
+    /*! \brief Get the dense index of a station.
+     *
+     *  \returns std::nullopt if the station is not in the network.
+     *
+     *  \note The index stays valid for the lifetime of the network, or until the next fromJson.
+     */
+    std::optional<StationIndex> getStationIndex(const Id& station) const;
+
+    /*! \brief Get the dense index of a route.
+     *
+     *  \returns std::nullopt if the route is not in the network.
+     *
+     *  \note The index stays valid for the lifetime of the network, or until the next fromJson.
+     */
+    std::optional<RouteIndex> getRouteIndex(const Id& route) const;
+
+    /*! \brief Get the travel time between 2 adjacent stations, by index.
+     *
+     *  \returns 0 if the function couldn't find the direct travel time.
+     */
+    unsigned int getAdjacentTravelTime(StationIndex stationA, StationIndex stationB) const;
+
+    /*! \brief Get the total travel time from stationA to stationB along a route, by index.
+     *
+     *  \returns 0 if the function could not find the travel time, or if both stations are the same.
+     *
+     *  \note The travel times along each route are precomputed, and the stops of the route at
+     *        each station are binary searched: this takes O(log k) time, k being the number of
+     *        route stops at stationA or stationB. On a circular route, it is the shortest ride
+     *        from a stop at stationA to a later stop at stationB, in time linear in the number of
+     *        stops of the route at both stations.
+     */
+    unsigned int getTravelTime(RouteIndex route, StationIndex stationA, StationIndex stationB) const;
+
 private:
+    // One hop of a route, from a stop to the next one.
+    struct RouteHop {
+        StationIndex from{};
+        StationIndex to{};
+        RouteIndex route{};
+    };
+
+    // A station passenger counter, on its own cache line so that
+    // threads updating neighbouring stations do not contend.
+    struct alignas(64) PassengerCounter {
+        std::atomic<long long> count{0};
+
+        PassengerCounter() = default;
+        PassengerCounter(const PassengerCounter& other) :
+            count{other.count.load(std::memory_order_relaxed)}
+        {}
+        PassengerCounter& operator=(const PassengerCounter& other) {
+            count.store(other.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+    };
+
+    // A directed edge in compressed sparse row form.
+    // The routes using this edge are m_edgeRoutes[routesBegin, routesEnd).
     struct Edge {
-        int travelTime{};
-        std::unordered_set<Id> routes;
+        StationIndex to{};
+        unsigned int travelTime{};
+        std::uint32_t routesBegin{};
+        std::uint32_t routesEnd{};
     };
-    struct Node {
-        std::string stationName{};
-        int passengerCount{};
-        std::unordered_map<const Node*, Edge> inEdges{};
-        std::unordered_map<const Node*, Edge> outEdges{};
+
+    // The position of a station along one of the routes serving it.
+    struct RouteStop {
+        RouteIndex route{};
+        std::uint32_t position{};
+
+        friend bool operator<(const RouteStop& lhs, const RouteStop& rhs) {
+            return std::tie(lhs.route, lhs.position) < std::tie(rhs.route, rhs.position);
+        }
     };
 
-    std::unordered_map<Id, Node> m_nodeMp{};
+    std::unordered_map<Id, StationIndex> m_stationIndexMp{};
+    std::vector<Id> m_stationIds{};
+    std::vector<std::string> m_stationNames{};
+    std::vector<PassengerCounter> m_passengerCounts{};
+
+    std::unordered_map<Id, RouteIndex> m_routeIndexMp{};
+    std::vector<Id> m_routeIds{};
+    std::vector<std::uint32_t> m_routeLines{};
+
+    std::unordered_map<Id, std::uint32_t> m_lineIndexMp{};
+    std::vector<Id> m_lineIds{};
+
+    // The stops of route r are m_routeStops[m_routeStopOffsets[r], m_routeStopOffsets[r+1]), in order.
+    // Each of those entries is a node of the journey search graph.
+    // m_routeTravelTimes holds, for each of those stops, the travel time from the start of the route.
+    // The stops are the source of truth for the graph topology.
+    std::vector<std::uint32_t> m_routeStopOffsets{0};
+    std::vector<StationIndex> m_routeStops{};
+    std::vector<unsigned int> m_routeTravelTimes{};
+
+    // The out edges of station i are m_edges[m_edgeOffsets[i], m_edgeOffsets[i+1]).
+    std::vector<std::uint32_t> m_edgeOffsets{0};
+    std::vector<Edge> m_edges{};
+    std::vector<RouteIndex> m_edgeRoutes{};
+
+    // The stops at station i, sorted by route index then position, are
+    // m_stationRoutes[m_stationRouteOffsets[i], m_stationRouteOffsets[i+1]).
+    // A circular route stops more than once at some stations.
+    std::vector<std::uint32_t> m_stationRouteOffsets{0};
+    std::vector<RouteStop> m_stationRoutes{};
 
+    bool insertLine(const Line& line);
+    void buildAdjacency();
+    const Edge* findEdge(StationIndex from, StationIndex to) const;
+    Edge* findEdge(StationIndex from, StationIndex to);
+    std::pair<const RouteStop*, const RouteStop*> findRouteStops(StationIndex station, RouteIndex route) const;
+    const RouteStop* findRouteStop(StationIndex station, RouteIndex route, std::uint32_t minPosition = 0) const;
+    const RouteStop* findHop(StationIndex from, StationIndex to, RouteIndex route) const;
+    RouteIndex getRouteOfStop(std::uint32_t stop) const;
+    void updateRouteTravelTimes(StationIndex from, const Edge& edge, unsigned int oldTravelTime);
 };
 
 
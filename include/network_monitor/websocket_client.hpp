@@ -1,6 +1,9 @@
 #ifndef NETWORK_MONITOR_WEBSOCKET_CLIENT_H
 #define NETWORK_MONITOR_WEBSOCKET_CLIENT_H
 
+#include <network_monitor/latency_histogram.hpp>
+#include <network_monitor/logger.hpp>
+
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/beast.hpp>
@@ -9,14 +12,65 @@
 
 #include <openssl/ssl.h>
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
 #include <functional>
-#include <iomanip>
-#include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace NetworkMonitor {
 
+/*! \brief Options of the permessage-deflate extension (RFC 7692).
+ *
+ *  The client offers them to the server in the WebSocket handshake. The window
+ *  size and the context takeover apply to both directions, while the levels only
+ *  tune the compressor of the client.
+ */
+struct WebSocketCompression {
+    //! Offer the extension. Messages are only compressed if the server accepts it.
+    bool enabled = false;
+
+    //! Base-2 logarithm of the LZ77 window, from 9 to 15. Smaller windows use
+    //! less memory per connection, but find fewer repetitions.
+    int windowBits = 15;
+
+    //! zlib memory level, from 1 to 9. Higher levels are faster and use more memory.
+    int memLevel = 4;
+
+    //! zlib compression level, from 0 (none) to 9 (smallest output, most CPU).
+    int level = 8;
+
+    //! Reset the window after each message. This saves the memory of the window
+    //! between messages, but repetitions across messages are no longer found.
+    bool noContextTakeover = false;
+};
+
+/*! \brief Counts of the TLS handshakes of a WebSocketClient, to follow session resumption.
+ */
+struct TlsResumptionStats {
+    //! Successful TLS handshakes.
+    unsigned handshakes = 0;
+
+    //! Handshakes in which the session of a previous connection was offered.
+    unsigned offered = 0;
+
+    //! Handshakes in which the server accepted the offered session.
+    unsigned resumed = 0;
+
+    /*! \brief The share of the offered sessions that were resumed, from 0 to 1.
+     */
+    double hitRate() const
+    {
+        return offered == 0 ? 0.0 : static_cast<double>(resumed) / offered;
+    }
+};
+
 /*! \brief Client to connect to a WebSocket server over TLS.
  *
  *  \tparam Resolver        The class to resolve the URL to an IP address. It
@@ -53,11 +107,22 @@ public:
         m_url{url},
         m_endpoint{endpoint},
         m_port{port},
+        m_ctx{ctx},
         m_resolver{boost::asio::make_strand(ioc)},
-        m_ws{boost::asio::make_strand(ioc), ctx}
+        m_ws{std::in_place, boost::asio::make_strand(ioc), ctx},
+        m_attemptTimer{m_ws->get_executor()}
     {}
 
     /*! \brief Connect to the server.
+     *
+     *  This can be called again once a previous connection is over, to reconnect: after onClose
+     *  was called, or after onDisconnect once a close() has completed. While the operations of
+     *  the previous connection are still running, onConnect is called with
+     *  boost::asio::error::in_progress instead. The new
+     *  connection reuses the strand, the TLS context, and the endpoints resolved the first time.
+     *  They are only resolved again once the resolve cache TTL has passed, or if connecting to
+     *  them fails. It also offers the TLS session
+     *  of the last connection, so that the server can resume it with an abbreviated handshake.
      *
      *  \param onConnect     Called when the connection fails or succeeds.
      *  \param onMessage     Called only when a message is successfully
@@ -72,51 +137,177 @@ public:
         std::function<void(boost::system::error_code)> onDisconnect = nullptr
     )
     {
+        // The stream of the previous connection cannot be replaced under its pending operations.
+        if(busy() ) {
+            log("Connect", boost::asio::error::in_progress);
+            boost::asio::post(m_ws->get_executor(), [onConnect]() {
+                if(onConnect)
+                    onConnect(boost::asio::error::in_progress);
+            });
+            return;
+        }
+
         // Save the user callbacks for later use.
         m_onConnect = onConnect;
         m_onMessage = onMessage;
         m_onDisconnect = onDisconnect;
 
+        // A stream cannot be connected twice: replace the one of the previous connection.
+        if(m_connection++ != 0) {
+            boost::beast::get_lowest_layer(*m_ws).close();
+            m_ws.emplace(m_ws->get_executor(), m_ctx);
+            m_rBuffer_.clear();
+        }
+        setDeflateOption();
+
         // Start the chain of asynchronous callbacks.
         m_closed = false;
+        m_connecting = true;
+        if(!m_endpoints.empty() && std::chrono::steady_clock::now() < m_endpointsExpiry) {
+            // Like a resolve, this completes from the executor and not from within connect().
+            boost::asio::post(m_ws->get_executor(), [this, endpoints = m_endpoints]() {
+                onResolve({}, endpoints);
+            });
+            return;
+        }
+        m_stageStart = std::chrono::steady_clock::now();
         m_resolver.async_resolve(m_url, m_port,
-            [this](auto ec, auto resolverIt) {
-                onResolve(ec, resolverIt);
+            [this](auto ec, auto endpoints) {
+                if(!ec)
+                    recordStage(m_latency->resolve);
+                onResolve(ec, endpoints);
             }
         );
     }
 
     /*! \brief Send a text message to the WebSocket server.
      *
-     *  \param message The message to send. The caller must ensure that this
-     *                 string stays in scope until the onSend handler is called.
+     *  Messages are queued, and written one at a time in the order they were
+     *  sent. The queue owns them, so the caller does not need to keep the
+     *  string alive. Messages queued while a write is in progress are written
+     *  back to back, from the completion handler of the previous write.
+     *
+     *  \param message The message to send.
      *  \param onSend  Called when a message is sent successfully or if it
      *                 failed to send.
      */
     void send(
-        const std::string& message,
+        std::string message,
         std::function<void(boost::system::error_code)> onSend = nullptr
     )
     {
-        m_ws.async_write(boost::asio::buffer(message),
-            [onSend](auto ec, auto) {
-                if(onSend)
-                    onSend(ec);
+        // Runs in place when called from the strand, from a handler.
+        boost::asio::dispatch(m_ws->get_executor(),
+            [this, message = std::move(message), onSend = std::move(onSend)]() mutable {
+                m_writeQueue.push_back({std::move(message), std::move(onSend)});
+                if(!m_writing)
+                    writeNext();
             }
         );
     }
 
+    /*! \brief Receive the messages as views over the read buffer, instead of
+     *         as new strings.
+     *
+     *  Once set, this handler is called instead of the onMessage handler given
+     *  to connect(). No string is allocated for the messages: the view is only
+     *  valid during the call, as the buffer is reused for the next message.
+     *
+     *  \param onMessageView Called only when a message is successfully
+     *                       received. Pass nullptr to use onMessage again.
+     */
+    void setOnMessageView(
+        std::function<void(boost::system::error_code, std::string_view)> onMessageView
+    )
+    {
+        m_onMessageView = std::move(onMessageView);
+    }
+
+    /*! \brief The executor (a strand) running the handlers of this connection.
+     */
+    auto getExecutor()
+    {
+        return m_ws->get_executor();
+    }
+
+    /*! \brief Set the compression offered on the next calls to connect().
+     *
+     *  \returns false, keeping the previous options, if one of them is out of range.
+     */
+    bool setCompression(const WebSocketCompression& compression)
+    {
+        if(compression.windowBits < 9 || compression.windowBits > 15
+           || compression.memLevel < 1 || compression.memLevel > 9
+           || compression.level < 0 || compression.level > 9)
+        {
+            return false;
+        }
+        m_compression = compression;
+        return true;
+    }
+
+    /*! \brief Set how long the resolved endpoints are reused by the following connections.
+     *
+     *  The system resolver does not report the DNS record TTL, so it is set here. Zero resolves
+     *  the name on every connection. The default is 5 minutes.
+     */
+    void setResolveCacheTtl(std::chrono::steady_clock::duration ttl)
+    {
+        m_resolveCacheTtl = ttl;
+    }
+
+    /*! \brief Set the delay before the next endpoint is tried, while the previous attempts are
+     *         still pending. The default is 250 ms, as recommended by RFC 8305.
+     *
+     *  The endpoints are attempted in staggered parallel: a slow or unreachable address only
+     *  delays the connection by this much, instead of the 5 s attempt timeout.
+     */
+    void setConnectionAttemptDelay(std::chrono::steady_clock::duration delay)
+    {
+        m_attemptDelay = delay;
+    }
+
+    /*! \brief The latency of each stage of the connections so far.
+     *
+     *  The histograms can be read from any thread while the client records into them.
+     */
+    const ConnectionLatency& getConnectionLatency() const
+    {
+        return *m_latency;
+    }
+
+    /*! \brief Record the latencies into other histograms, for example to share them between
+     *         the clients of a process.
+     */
+    void setConnectionLatency(std::shared_ptr<ConnectionLatency> latency)
+    {
+        m_latency = std::move(latency);
+    }
+
+    /*! \brief The TLS handshakes so far, and how many resumed a previous session.
+     */
+    const TlsResumptionStats& getTlsResumptionStats() const
+    {
+        return m_tlsStats;
+    }
+
     /*! \brief Close the WebSocket connection.
      *
      *  \param onClose Called when the connection is closed, successfully or
-     *                 not.
+     *                 not. The pending read and write, if any, have completed
+     *                 by then, so connect() can be called again from it.
      */
     void close(std::function<void(boost::system::error_code)> onClose = nullptr) {
         m_closed = true;
-        m_ws.async_close(boost::beast::websocket::close_code::none,
-            [onClose](auto ec) {
-                if(onClose)
-                    onClose(ec);
+        ++m_closing;
+        m_ws->async_close(boost::beast::websocket::close_code::none,
+            [this, onClose](auto ec) {
+                --m_closing;
+                m_onIdle.push_back([onClose, ec]() {
+                    if(onClose)
+                        onClose(ec);
+                });
+                notifyIdle();
             }
         );
     }
@@ -125,67 +316,251 @@ private:
     std::string m_url{};
     std::string m_endpoint{};
     std::string m_port{};
+    boost::asio::ssl::context& m_ctx;
 
     // We leave these uninitialized because they do not support a default
-    // constructor.
+    // constructor. The stream cannot be move-assigned either, so it is
+    // replaced in place on reconnection.
     Resolver m_resolver;
-    WebSocketStream m_ws;
+    std::optional<WebSocketStream> m_ws;
 
     boost::beast::flat_buffer m_rBuffer_{};
 
+    struct PendingWrite {
+        std::string message{};
+        std::function<void(boost::system::error_code)> onSend{};
+    };
+    // Only the front message can be in the process of being written.
+    // A deque, so that queuing more messages does not move it.
+    std::deque<PendingWrite> m_writeQueue{};
+    bool m_writing = false;
+
+    // Kept for the following connections.
+    boost::asio::ip::tcp::resolver::results_type m_endpoints{};
+    std::chrono::steady_clock::time_point m_endpointsExpiry{};
+    std::chrono::steady_clock::duration m_resolveCacheTtl{std::chrono::minutes(5)};
+
+    // Connection attempts of the current race, one per endpoint tried so far. Failed or
+    // cancelled attempts are reset.
+    using TcpStream = std::remove_reference_t<
+        decltype(boost::beast::get_lowest_layer(std::declval<WebSocketStream&>() ) )
+    >;
+    std::vector<boost::asio::ip::tcp::endpoint> m_raceEndpoints{};
+    std::vector<std::unique_ptr<TcpStream> > m_attempts{};
+    boost::system::error_code m_raceEc{};
+    boost::asio::steady_timer m_attemptTimer;
+    std::chrono::steady_clock::duration m_attemptDelay{std::chrono::milliseconds(250)};
+    // Number of races started, to tell the handlers of a previous one apart.
+    unsigned m_race = 0;
+    // Number of calls to connect(), as the first one uses the stream built by the constructor.
+    unsigned m_connection = 0;
+
+    WebSocketCompression m_compression{};
+
+    // Session of the last connection, offered on the next handshake with the same host.
+    std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> m_tlsSession{nullptr, SSL_SESSION_free};
+    TlsResumptionStats m_tlsStats{};
+
+    std::shared_ptr<ConnectionLatency> m_latency{std::make_shared<ConnectionLatency>()};
+    // Start of the connection stage in progress.
+    std::chrono::steady_clock::time_point m_stageStart{};
+    bool m_awaitingFirstMessage = false;
+
     bool m_closed = true;
 
+    // Operations running on the stream, which must complete before it is replaced.
+    bool m_connecting = false;
+    bool m_reading = false;
+    unsigned m_closing = 0;
+    // Called once none of the operations above is running, in order.
+    std::vector<std::function<void()> > m_onIdle{};
+
     std::function<void (boost::system::error_code)> m_onConnect{};
     std::function<void (boost::system::error_code, std::string&&)> m_onMessage{};
+    std::function<void (boost::system::error_code, std::string_view)> m_onMessageView{};
     std::function<void (boost::system::error_code)> m_onDisconnect{};
 
     static void log(const std::string& where, boost::system::error_code ec) {
-        std::cerr << "[" << std::setw(20) << where << "] "
-                  << (ec ? "Error: " : "OK")
-                  << (ec ? ec.message() : "")
-                  << std::endl;
+        if(ec)
+            logError("[", where, "] Error: ", ErrorMessage{ec});
+        else
+            logDebug("[", where, "] OK");
+    }
+
+    bool busy() const {
+        return m_connecting || m_reading || m_writing || m_closing != 0;
+    }
+
+    void notifyIdle() {
+        if(busy() || m_onIdle.empty() )
+            return;
+        // The callbacks may close or connect again.
+        const auto onIdle = std::move(m_onIdle);
+        m_onIdle.clear();
+        for(const auto& callback : onIdle)
+            callback();
+    }
+
+    // End the chain of callbacks started by connect().
+    void completeConnect(const boost::system::error_code& ec) {
+        m_connecting = false;
+        if(m_onConnect)
+            m_onConnect(ec);
+    }
+
+    // Record the time since the start of the stage, and start the next one.
+    void recordStage(LatencyHistogram& histogram) {
+        const auto now = std::chrono::steady_clock::now();
+        histogram.record(now - m_stageStart);
+        m_stageStart = now;
+    }
+
+    // The offer is part of the handshake, so it must be set on each new stream.
+    void setDeflateOption() {
+        boost::beast::websocket::permessage_deflate deflate{};
+        deflate.client_enable = m_compression.enabled;
+        deflate.client_max_window_bits = m_compression.windowBits;
+        deflate.server_max_window_bits = m_compression.windowBits;
+        deflate.client_no_context_takeover = m_compression.noContextTakeover;
+        deflate.server_no_context_takeover = m_compression.noContextTakeover;
+        deflate.memLevel = m_compression.memLevel;
+        deflate.compLevel = m_compression.level;
+        m_ws->set_option(deflate);
+    }
+
+    // Beast allows a single async_write at a time: the next one starts when it completes.
+    void writeNext() {
+        if(m_writeQueue.empty() ) {
+            m_writing = false;
+            notifyIdle();
+            return;
+        }
+        m_writing = true;
+        m_ws->async_write(boost::asio::buffer(m_writeQueue.front().message),
+            [this](auto ec, auto) {
+                const auto onSend = std::move(m_writeQueue.front().onSend);
+                m_writeQueue.pop_front();
+                if(onSend)
+                    onSend(ec);
+                writeNext();
+            }
+        );
     }
 
     void onResolve(
         const boost::system::error_code& ec,
-        boost::asio::ip::tcp::resolver::iterator resolverIt
+        boost::asio::ip::tcp::resolver::results_type endpoints
     )
     {
         if(ec) {
             log("OnResolve", ec);
-            if(m_onConnect)
-                m_onConnect(ec);
+            completeConnect(ec);
             return;
         }
 
+        if(endpoints != m_endpoints) {
+            m_endpoints = endpoints;
+            m_endpointsExpiry = std::chrono::steady_clock::now() + m_resolveCacheTtl;
+        }
+        raceEndpoints();
+    }
+
+    // Happy Eyeballs (RFC 8305): the endpoints are tried in turn, alternating address
+    // families, each attempt starting when the previous one fails or after the attempt delay.
+    // The first one to connect wins and the others are cancelled.
+    void raceEndpoints() {
+        ++m_race;
+        m_attempts.clear();
+        m_raceEndpoints.clear();
+        m_raceEc = {};
+        m_stageStart = std::chrono::steady_clock::now();
+        std::vector<boost::asio::ip::tcp::endpoint> v4{};
+        std::vector<boost::asio::ip::tcp::endpoint> v6{};
+        for(const auto& entry : m_endpoints)
+            (entry.endpoint().address().is_v6() ? v6 : v4).push_back(entry.endpoint() );
+        for(size_t i=0; i<std::max(v4.size(), v6.size() ); ++i) {
+            if(i < v6.size() )
+                m_raceEndpoints.push_back(v6[i]);
+            if(i < v4.size() )
+                m_raceEndpoints.push_back(v4[i]);
+        }
+        if(m_raceEndpoints.empty() ) {
+            onConnect(boost::asio::error::host_not_found);
+            return;
+        }
+        startAttempt();
+    }
+
+    void startAttempt() {
+        const size_t index = m_attempts.size();
+        if(index == m_raceEndpoints.size() )
+            return;
+        m_attempts.push_back(std::make_unique<TcpStream>(m_ws->get_executor() ) );
+
         // The following timeout only matters for the purpose of connecting to
         // the TCP socket. We will reset the timeout to a sensible default
         // after we are connected.
-        // Note: The TCP layer is the lowest layer (WebSocket -> TLS -> TCP).
-        boost::beast::get_lowest_layer(m_ws).expires_after(std::chrono::seconds(5) );
-
-        // Connect to the TCP socket.
-        // Note: The TCP layer is the lowest layer (WebSocket -> TLS -> TCP).
-        boost::beast::get_lowest_layer(m_ws).async_connect(*resolverIt,
-            [this](auto ec) {
-                onConnect(ec);
+        m_attempts.back()->expires_after(std::chrono::seconds(5) );
+        m_attempts.back()->async_connect(m_raceEndpoints[index],
+            [this, race = m_race, index](auto ec) {
+                onAttempt(ec, race, index);
             }
         );
+
+        m_attemptTimer.expires_after(m_attemptDelay);
+        m_attemptTimer.async_wait([this, race = m_race](auto ec) {
+            if(!ec && race == m_race)
+                startAttempt();
+        });
+    }
+
+    void onAttempt(const boost::system::error_code& ec, unsigned race, size_t index) {
+        // The race is over, or was replaced by a new call to connect().
+        if(race != m_race || !m_attempts[index])
+            return;
+
+        if(ec) {
+            m_attempts[index].reset();
+            m_raceEc = ec;
+            // Do not wait for the attempt delay to try the next endpoint.
+            if(m_attempts.size() < m_raceEndpoints.size() ) {
+                m_attemptTimer.cancel();
+                startAttempt();
+            }
+            else if(std::none_of(m_attempts.begin(), m_attempts.end(), [](const auto& attempt) {
+                return attempt != nullptr;
+            }))
+            {
+                ++m_race;
+                m_attemptTimer.cancel();
+                onConnect(m_raceEc);
+            }
+            return;
+        }
+
+        // Take the socket of the winner. Destroying the other attempts cancels them.
+        ++m_race;
+        m_attemptTimer.cancel();
+        boost::beast::get_lowest_layer(*m_ws).socket() = std::move(m_attempts[index]->socket() );
+        m_attempts.clear();
+        recordStage(m_latency->tcpConnect);
+        onConnect(ec);
     }
 
     void onConnect(const boost::system::error_code& ec) {
         if(ec) {
             log("OnConnect", ec);
-            if(m_onConnect)
-                m_onConnect(ec);
+            // The server may have moved: resolve its name again next time.
+            m_endpoints = {};
+            completeConnect(ec);
             return;
         }
 
         // Now that the TCP socket is connected, we can reset the timeout to
         // whatever Boost.Beast recommends.
         // Note: The TCP layer is the lowest layer (WebSocket -> TLS -> TCP).
-        boost::beast::get_lowest_layer(m_ws).expires_never();
-        m_ws.set_option(
+        boost::beast::get_lowest_layer(*m_ws).expires_never();
+        m_ws->set_option(
             boost::beast::websocket::stream_base::timeout::suggested(
                 boost::beast::role_type::client
             )
@@ -195,13 +570,16 @@ private:
         // handshake or the connection will fail. We use an OpenSSL function
         // for that.
         SSL_set_tlsext_host_name(
-            m_ws.next_layer().native_handle(),
+            m_ws->next_layer().native_handle(),
             m_url.c_str()
         );
+        if(m_tlsSession && SSL_set_session(m_ws->next_layer().native_handle(), m_tlsSession.get() ) == 1)
+            ++m_tlsStats.offered;
 
         // Attempt a TLS handshake.
         // Note: The TLS layer is the next layer (WebSocket -> TLS -> TCP).
-        m_ws.next_layer().async_handshake(boost::asio::ssl::stream_base::client,
+        m_stageStart = std::chrono::steady_clock::now();
+        m_ws->next_layer().async_handshake(boost::asio::ssl::stream_base::client,
             [this](auto ec) {
                 onTlsHandshake(ec);
             }
@@ -211,13 +589,18 @@ private:
     void onTlsHandshake(const boost::system::error_code& ec) {
         if(ec) {
             log("OnTlsHandshake", ec);
-            if(m_onConnect)
-                m_onConnect(ec);
+            // The session may be the cause: do not offer it again.
+            m_tlsSession.reset();
+            completeConnect(ec);
             return;
         }
+        ++m_tlsStats.handshakes;
+        recordStage(m_latency->tlsHandshake);
+        if(SSL_session_reused(m_ws->next_layer().native_handle() ) )
+            ++m_tlsStats.resumed;
 
         // Attempt a WebSocket handshake.
-        m_ws.async_handshake(m_url, m_endpoint,
+        m_ws->async_handshake(m_url, m_endpoint,
             [this](auto ec) {
                 onHandshake(ec);
             }
@@ -227,13 +610,23 @@ private:
     void onHandshake(const boost::system::error_code& ec) {
         if(ec) {
             log("OnHandshake", ec);
-            if(m_onConnect)
-                m_onConnect(ec);
+            completeConnect(ec);
             return;
         }
 
+        recordStage(m_latency->wsUpgrade);
+        m_awaitingFirstMessage = true;
+
         // Tell the WebSocket object to exchange messages in text format.
-        m_ws.text(true);
+        m_ws->text(true);
+
+        // TLS 1.3 servers send the session tickets after the handshake: by the time the
+        // WebSocket upgrade response is read, the session can be saved for the next connection.
+        SSL_SESSION* session = SSL_get1_session(m_ws->next_layer().native_handle() );
+        if(session && SSL_SESSION_is_resumable(session) == 1)
+            m_tlsSession.reset(session);
+        else if(session)
+            SSL_SESSION_free(session);
 
         // Now that we are connected, set up a recursive asynchronous listener
         // to receive messages.
@@ -241,8 +634,7 @@ private:
 
         // Dispatch the user callback.
         // Note: This call is synchronous and will block the WebSocket strand.
-        if(m_onConnect)
-            m_onConnect(ec);
+        completeConnect(ec);
     }
 
     void listenToIncomingMessage(const boost::system::error_code& ec) {
@@ -256,10 +648,13 @@ private:
         // Read a message asynchronously. On a successful read, process the
         // message and recursively call this function again to process the next
         // message.
-        m_ws.async_read(m_rBuffer_,
+        m_reading = true;
+        m_ws->async_read(m_rBuffer_,
             [this](auto ec, auto nBytes) {
+                m_reading = false;
                 onRead(ec, nBytes);
                 listenToIncomingMessage(ec);
+                notifyIdle();
             }
         );
     }
@@ -268,9 +663,22 @@ private:
         // We just ignore messages that failed to read.
         if(ec)
             return;
+        if(m_awaitingFirstMessage) {
+            m_awaitingFirstMessage = false;
+            recordStage(m_latency->firstMessage);
+        }
+
+        // Note: These calls are synchronous and will block the WebSocket strand.
+        if(m_onMessageView) {
+            // A flat_buffer holds its data in a single contiguous buffer. It is
+            // reused for the next message once consumed.
+            const auto data {m_rBuffer_.data()};
+            m_onMessageView(ec, {static_cast<const char*>(data.data() ), data.size()});
+            m_rBuffer_.consume(nBytes);
+            return;
+        }
 
         // Parse the message and forward it to the user callback.
-        // Note: This call is synchronous and will block the WebSocket strand.
         std::string message {boost::beast::buffers_to_string(m_rBuffer_.data() )};
         m_rBuffer_.consume(nBytes);
         if(m_onMessage)
@@ -1,5 +1,6 @@
 
 #include <network_monitor/file_downloader.hpp>
+#include <network_monitor/logger.hpp>
 
 #include <curl/curl.h>
 
@@ -22,26 +23,26 @@ bool downloadFile(
         curl_easy_cleanup,
     };
     if(!curl) {
-        std::cerr<<"Unable to initialise curl"<<std::endl;
+        logError("Unable to initialise curl");
         return false;
     }
     CURLcode err = CURLE_OK;
 
     err = curl_easy_setopt(curl.get(), CURLOPT_URL, fileURL.c_str() );
     if(err != CURLE_OK) {
-        std::cerr<<"CURLOPT_URL error: "<<curl_easy_strerror(err)<<std::endl;
+        logError("CURLOPT_URL error: ", curl_easy_strerror(err));
         return false;
     }
 
     err = curl_easy_setopt(curl.get(), CURLOPT_CAINFO, cacertFile.c_str() );
     if(err != CURLE_OK) {
-        std::cerr<<"CURLOPT_CAINFO: "<<curl_easy_strerror(err)<<std::endl;
+        logError("CURLOPT_CAINFO: ", curl_easy_strerror(err));
         return false;
     }
 
     err = curl_easy_setopt(curl.get(), CURLOPT_FOLLOWLOCATION, 1L);
     if(err != CURLE_OK) {
-        std::cerr<<"CURLOPT_FOLLOWLOCATION error: "<<curl_easy_strerror(err)<<std::endl;
+        logError("CURLOPT_FOLLOWLOCATION error: ", curl_easy_strerror(err));
         return false;
     }
 
@@ -55,13 +56,13 @@ bool downloadFile(
     }
     err = curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, inputFile.get() );
     if(err != CURLE_OK) {
-        std::cerr<<"CURLOPT_WRITEDATA error: "<<curl_easy_strerror(err)<<std::endl;
+        logError("CURLOPT_WRITEDATA error: ", curl_easy_strerror(err));
         return false;
     }
 
     err = curl_easy_perform(curl.get() );
     if(err != CURLE_OK) {
-        std::cerr<<"CURL file transfer error: "<<curl_easy_strerror(err)<<std::endl;
+        logError("CURL file transfer error: ", curl_easy_strerror(err));
         return false;
     }
 
@@ -70,14 +71,14 @@ bool downloadFile(
 
 nlohmann::json parseJsonFile(const std::filesystem::path& source) {
     if(!std::filesystem::exists(source) ) {
-        std::cerr<<__func__<<":"<<__LINE__<<": unable to find line: "<<source<<std::endl;
+        logError(__func__, ":", __LINE__, ": unable to find line: ", source);
         return nlohmann::json::value_t::discarded;
     }
     std::ifstream inputFile{source};
     try {
         return nlohmann::json::parse(inputFile);
     } catch(std::exception& ex) {
-        std::cerr<<__func__<<":"<<__LINE__<<": JSON parsing error: "<<ex.what()<<std::endl;
+        logError(__func__, ":", __LINE__, ": JSON parsing error: ", ex.what());
         return nlohmann::json::value_t::discarded;
     }
 }
@@ -0,0 +1,100 @@
+#include <network_monitor/io_context_pool.hpp>
+#include <network_monitor/logger.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace NetworkMonitor {
+
+namespace  {
+
+// Restrict a thread to one core, so that a context keeps its caches warm.
+void pinToCore(std::thread& thread, size_t core) {
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(core, &cpuSet);
+    const int err = pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet);
+    if(err != 0)
+        logWarning("io context pool: could not pin a thread to core ", core, ": error ", err);
+#else
+    static_cast<void>(thread);
+    static_cast<void>(core);
+#endif
+}
+
+size_t hardwareThreads() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+} // namespace
+
+IoContextPool::IoContextPool(size_t size, bool pinThreads) :
+    m_pinThreads{pinThreads}
+{
+    size = size != 0 ? size : hardwareThreads();
+    m_contexts.reserve(size);
+    for(size_t i=0; i<size; ++i) {
+        // Each context is only run by one thread: Asio can skip its internal locking.
+        m_contexts.push_back(std::make_unique<boost::asio::io_context>(1) );
+    }
+}
+
+IoContextPool::~IoContextPool() {
+    stop();
+}
+
+void IoContextPool::run() {
+    if(!m_threads.empty() )
+        return;
+    const size_t cores = hardwareThreads();
+    m_threads.reserve(m_contexts.size() );
+    for(size_t i=0; i<m_contexts.size(); ++i) {
+        auto& ioc = *m_contexts[i];
+        ioc.restart();
+        m_work.push_back(boost::asio::make_work_guard(ioc) );
+        m_threads.emplace_back([&ioc]() {
+            ioc.run();
+        });
+        if(m_pinThreads)
+            pinToCore(m_threads.back(), i % cores);
+    }
+}
+
+void IoContextPool::stop() {
+    m_work.clear();
+    for(auto& ioc : m_contexts)
+        ioc->stop();
+    for(auto& thread : m_threads)
+        thread.join();
+    m_threads.clear();
+}
+
+size_t IoContextPool::size() const {
+    return m_contexts.size();
+}
+
+boost::asio::io_context& IoContextPool::next() {
+    return *m_contexts[m_next.fetch_add(1, std::memory_order_relaxed) % m_contexts.size()];
+}
+
+boost::asio::io_context& IoContextPool::forKey(std::string_view key) {
+    return *m_contexts[std::hash<std::string_view>{}(key) % m_contexts.size()];
+}
+
+boost::asio::io_context& IoContextPool::at(size_t index) {
+    if(index >= m_contexts.size() )
+        throw std::out_of_range("IoContextPool: no context at index " + std::to_string(index) );
+    return *m_contexts[index];
+}
+
+} //namespace NetworkMonitor
@@ -0,0 +1,109 @@
+#include <network_monitor/latency_histogram.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iomanip>
+
+namespace NetworkMonitor {
+
+namespace  {
+
+size_t bucketOf(uint64_t us) {
+    if(us < 4)
+        return us;
+    const size_t msb = std::bit_width(us) - 1;
+    const size_t sub = (us >> (msb - 2) ) & 3;
+    return std::min(4 * (msb - 1) + sub, LatencyHistogram::bucketCount - 1);
+}
+
+} // namespace
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    const uint64_t ns = static_cast<uint64_t>(std::max<std::chrono::nanoseconds::rep>(latency.count(), 0) );
+    m_buckets[bucketOf(ns / 1000)].fetch_add(1, std::memory_order_relaxed);
+    m_sumNs.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = m_maxNs.load(std::memory_order_relaxed);
+    while(ns > max && !m_maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed) ) {}
+    m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    return m_count.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds LatencyHistogram::mean() const {
+    const uint64_t count = m_count.load(std::memory_order_relaxed);
+    if(count == 0)
+        return {};
+    return std::chrono::nanoseconds(m_sumNs.load(std::memory_order_relaxed) / count);
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const {
+    return std::chrono::nanoseconds(m_maxNs.load(std::memory_order_relaxed) );
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double share) const {
+    const auto counts = buckets();
+    uint64_t total = 0;
+    for(const uint64_t n : counts)
+        total += n;
+    if(total == 0)
+        return {};
+
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(share, 0.0, 1.0) * total) ) );
+    uint64_t seen = 0;
+    for(size_t i=0; i<bucketCount; ++i) {
+        seen += counts[i];
+        if(seen >= rank)
+            return std::min<std::chrono::nanoseconds>(bucketUpperBound(i), max() );
+    }
+    return max();
+}
+
+std::array<uint64_t, LatencyHistogram::bucketCount> LatencyHistogram::buckets() const {
+    std::array<uint64_t, bucketCount> counts{};
+    for(size_t i=0; i<bucketCount; ++i)
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+    return counts;
+}
+
+std::chrono::microseconds LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if(bucket < 4)
+        return std::chrono::microseconds(bucket + 1);
+    const size_t msb = bucket / 4 + 1;
+    const size_t sub = bucket % 4;
+    return std::chrono::microseconds( (5 + sub) << (msb - 2) );
+}
+
+void LatencyHistogram::reset() {
+    for(auto& bucket : m_buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumNs.store(0, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+void printLatency(std::ostream& os, std::string_view name, const LatencyHistogram& histogram) {
+    const auto us = [](std::chrono::nanoseconds ns) {
+        return std::chrono::duration<double, std::micro>(ns).count();
+    };
+    os << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(0)
+       << " count " << std::setw(8) << histogram.count()
+       << "  mean " << std::setw(9) << us(histogram.mean() )
+       << "  p50 " << std::setw(9) << us(histogram.percentile(0.5) )
+       << "  p90 " << std::setw(9) << us(histogram.percentile(0.9) )
+       << "  p99 " << std::setw(9) << us(histogram.percentile(0.99) )
+       << "  max " << std::setw(9) << us(histogram.max() ) << " us" << std::endl;
+}
+
+std::ostream& operator<<(std::ostream& os, const ConnectionLatency& latency) {
+    printLatency(os, "resolve", latency.resolve);
+    printLatency(os, "tcp connect", latency.tcpConnect);
+    printLatency(os, "tls handshake", latency.tlsHandshake);
+    printLatency(os, "ws upgrade", latency.wsUpgrade);
+    printLatency(os, "first message", latency.firstMessage);
+    return os;
+}
+
+} //namespace NetworkMonitor
@@ -0,0 +1,119 @@
+#include <network_monitor/logger.hpp>
+
+#include <ctime>
+#include <iomanip>
+
+namespace NetworkMonitor {
+
+namespace  {
+
+size_t roundUpToPowerOf2(size_t value) {
+    size_t power = 2;
+    while(power < value)
+        power *= 2;
+    return power;
+}
+
+// UTC time of day, with microseconds: 07:18:50.234000
+void printTime(std::ostream& os, std::chrono::system_clock::time_point time) {
+    const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+        time.time_since_epoch() % std::chrono::seconds(1) ).count();
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    os << std::put_time(&utc, "%T") << '.' << std::setfill('0') << std::setw(6) << us << std::setfill(' ');
+}
+
+} // namespace
+
+std::ostream& operator<<(std::ostream& os, LogLevel level) {
+    switch(level) {
+    case LogLevel::Debug:
+        return os << "debug";
+    case LogLevel::Info:
+        return os << "info";
+    case LogLevel::Warning:
+        return os << "warning";
+    case LogLevel::Error:
+        return os << "error";
+    }
+    return os << "unknown";
+}
+
+std::ostream& operator<<(std::ostream& os, const ErrorMessage& error) {
+    return os << error.ec.message();
+}
+
+Logger::Logger(std::ostream& sink, size_t capacity) :
+    m_slots{std::make_unique<Slot[]>(roundUpToPowerOf2(capacity) )},
+    m_mask{roundUpToPowerOf2(capacity) - 1},
+    m_sink{sink}
+{
+    for(size_t i=0; i<=m_mask; ++i)
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    m_thread = std::thread([this]() {
+        run();
+    });
+}
+
+Logger::~Logger() {
+    m_running.store(false, std::memory_order_release);
+    m_thread.join();
+}
+
+Logger& Logger::global() {
+    static Logger logger{};
+    return logger;
+}
+
+void Logger::flush() {
+    const size_t head = m_head.load(std::memory_order_acquire);
+    while(m_tail.load(std::memory_order_acquire) < head)
+        std::this_thread::sleep_for(std::chrono::microseconds(100) );
+}
+
+uint64_t Logger::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void Logger::run() {
+    std::ostringstream batch{};
+    while(m_running.load(std::memory_order_acquire) ) {
+        if(!drain(batch) )
+            std::this_thread::sleep_for(std::chrono::milliseconds(1) );
+    }
+    // Messages logged before the logger was destroyed.
+    while(drain(batch) ) {}
+}
+
+bool Logger::drain(std::ostringstream& batch) {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t first = tail;
+    for(;;) {
+        Slot& slot = m_slots[tail & m_mask];
+        if(slot.sequence.load(std::memory_order_acquire) != tail + 1)
+            break;
+        printTime(batch, slot.time);
+        batch << " [" << slot.level << "] ";
+        slot.format(batch, slot.args);
+        batch << '\n';
+        // Hand the slot back to the producers, for the next lap of the ring.
+        slot.sequence.store(tail + m_mask + 1, std::memory_order_release);
+        ++tail;
+    }
+    if(tail == first)
+        return false;
+
+    // A single write, and flush, for the whole batch.
+    m_sink << batch.str();
+    m_sink.flush();
+    batch.str({});
+    m_tail.store(tail, std::memory_order_release);
+    return true;
+}
+
+} //namespace NetworkMonitor
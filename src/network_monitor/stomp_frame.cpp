@@ -1,20 +1,20 @@
 
 #include <network_monitor/stomp_frame.hpp>
 
-#include <boost/fusion/adapted/std_pair.hpp>
-#include <boost/fusion/adapted/std_tuple.hpp>
-#include <boost/spirit/home/x3.hpp>
-
 #include <array>
+#include <charconv>
+#include <cstring>
 #include <iostream>
+#include <optional>
 #include <stdexcept>
 #include <string>
-#include <sstream>
 #include <string_view>
-#include <tuple>
+#include <system_error>
 #include <utility>
 
-#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 
 using std::string_literals::operator""s, std::string_view_literals::operator""sv;
@@ -23,7 +23,67 @@ namespace NetworkMonitor {
 
 namespace  {
 
-const std::array<std::string_view, StompCommand_count> stompCommandLookup = {
+/*  Compile-time perfect hash from a set of names to their enum values.
+ *
+ *  The hash mixes the length with the first, middle and last characters. makeNameTable() searches
+ *  for a seed giving no collisions, so a lookup is one hash and one string comparison.
+ */
+constexpr size_t nameTableSlots = 64;
+
+constexpr size_t hashName(std::string_view name, size_t seed) {
+    size_t hash = name.size();
+    hash = hash * seed + static_cast<unsigned char>(name.front() );
+    hash = hash * seed + static_cast<unsigned char>(name[name.size() / 2]);
+    hash = hash * seed + static_cast<unsigned char>(name.back() );
+    return hash % nameTableSlots;
+}
+
+template <typename Enum>
+struct NameTable {
+    size_t seed{};
+    std::array<std::string_view, nameTableSlots> names{};
+    std::array<Enum, nameTableSlots> values{};
+
+    constexpr std::optional<Enum> find(std::string_view name) const {
+        if(name.empty() )
+            return std::nullopt;
+        const size_t slot = hashName(name, seed);
+        if(names[slot] != name)
+            return std::nullopt;
+        return values[slot];
+    }
+};
+
+template <typename Enum, size_t N>
+constexpr NameTable<Enum> makeNameTable(const std::array<std::pair<std::string_view, Enum>, N>& entries) {
+    // Never terminating here makes the constant evaluation, and so the build, fail.
+    for(size_t seed = 1; ; ++seed) {
+        NameTable<Enum> table{seed};
+        bool collision = false;
+        for(const auto& [name, value] : entries) {
+            const size_t slot = hashName(name, seed);
+            if(!table.names[slot].empty() ) {
+                collision = true;
+                break;
+            }
+            table.names[slot] = name;
+            table.values[slot] = value;
+        }
+        if(!collision)
+            return table;
+    }
+}
+
+template <typename Enum, size_t N>
+constexpr std::array<std::pair<std::string_view, Enum>, N> enumerate(const std::array<std::string_view, N>& lookup) {
+    std::array<std::pair<std::string_view, Enum>, N> entries{};
+    for(size_t i=0; i<N; ++i)
+        entries[i] = {lookup[i], static_cast<Enum>(i)};
+    return entries;
+}
+
+
+constexpr std::array<std::string_view, StompCommand_count> stompCommandLookup = {
     "CONNECTED",
     "DISCONNECT",
     "ERROR",
@@ -34,26 +94,31 @@ const std::array<std::string_view, StompCommand_count> stompCommandLookup = {
     "SUBSCRIBE",
 };
 
+constexpr auto stompCommandTable = [] {
+    const auto commands = enumerate<StompCommand>(stompCommandLookup);
+    std::array<std::pair<std::string_view, StompCommand>, StompCommand_count + 1> entries{};
+    for(size_t i=0; i<StompCommand_count; ++i)
+        entries[i] = commands[i];
+    // STOMP v1.2 servers accept CONNECT as well, for compatibility with STOMP v1.0.
+    entries[StompCommand_count] = {"CONNECT", StompCommand::Stomp};
+    return makeNameTable(entries);
+}();
+
 std::string_view toStringView(StompCommand sc) {
     return stompCommandLookup[static_cast<size_t>(sc)];
 }
 
-StompCommand toStompCommand(std::string_view sc) {
-    for(size_t i=0; i<size(stompCommandLookup); ++i) {
-        if(stompCommandLookup[i] == sc)
-            return static_cast<StompCommand>(i);
-    }
-    if(sc == "CONNECT")
-        return StompCommand::Stomp;
-    throw std::runtime_error("Invalid stomp command: "s + std::string(sc) );
+std::optional<StompCommand> toStompCommand(std::string_view sc) {
+    return stompCommandTable.find(sc);
 }
 
-const std::array<std::string_view, StompHeader_count> stompHeaderLookup = {
+constexpr std::array<std::string_view, StompHeader_count> stompHeaderLookup = {
     "accept-version",
     "ack",
     "content-length",
     "content-type",
     "destination",
+    "heart-beat",
     "host",
     "id",
     "login",
@@ -66,67 +131,133 @@ const std::array<std::string_view, StompHeader_count> stompHeaderLookup = {
     "version",
 };
 
+constexpr auto stompHeaderTable = makeNameTable(enumerate<StompHeader>(stompHeaderLookup) );
+
 std::string_view toStringView(StompHeader sh) {
     return stompHeaderLookup[static_cast<size_t>(sh)];
 }
 
-StompHeader toStompHeader(std::string_view sh) {
-    for(size_t i=0; i<size(stompHeaderLookup); ++i) {
-        if(stompHeaderLookup[i] == sh)
-            return static_cast<StompHeader>(i);
-    }
-    throw std::runtime_error("Invalid stomp header: "s + std::string(sh) );
+std::optional<StompHeader> toStompHeader(std::string_view sh) {
+    return stompHeaderTable.find(sh);
 }
 
+static_assert(stompCommandTable.find("CONNECT") == StompCommand::Stomp);
+static_assert(stompHeaderTable.find("content-length") == StompHeader::ContentLength);
+static_assert(!stompHeaderTable.find("content-lengthx") );
 
-std::string unEscapeString(std::string&& str) {
-    bool isEscape = false;
-    size_t j = 0;
+bool isValidEscape(char c) {
+    return c == 'n' || c == 'r' || c == 'c' || c == '\\';
+}
+
+/*  Check that every backslash in an escaped header value starts a valid escape sequence.
+ */
+bool isValidEscaped(std::string_view str) {
     for(size_t i=0; i<str.size(); ++i) {
-        if(str[i] == '\\') {
-            isEscape = true;
+        if(str[i] != '\\')
+            continue;
+        if(++i == str.size() || !isValidEscape(str[i]) )
+            return false;
+    }
+    return true;
+}
+
+/*  Append the unescaped value of a (validated) escaped header value to out.
+ */
+void unEscapeInto(std::string_view str, std::string& out) {
+    for(size_t i=0; i<str.size(); ++i) {
+        if(str[i] != '\\') {
+            out.push_back(str[i]);
             continue;
         }
-        if(isEscape) {
-            isEscape = false;
-            if(str[i] == 'n')
-                str[j] = '\n';
-            else if(str[i] == 'r')
-                str[j] = '\r';
-            else if(str[i] == ':')
-                str[j] = ':';
-            else
-                throw std::runtime_error("Invalid escape character: \\"s + str[i]);
-        } else {
-            str[j] = str[i];
+        switch(str[++i]) {
+        case 'n':
+            out.push_back('\n');
+        break;
+        case 'r':
+            out.push_back('\r');
+        break;
+        case 'c':
+            out.push_back(':');
+        break;
+        default:
+            out.push_back('\\');
+        break;
         }
-        ++j;
     }
-    str.resize(j);
-    return str;
-}
-
-std::string escapeString(std::string_view str) {
-    std::string ret;
-    ret.reserve(str.size() );
-    for(const char c : str) {
-        if(c == '\n') {
-            ret.push_back('\\');
-            ret.push_back('n');
-        } else if(c == '\r') {
-            ret.push_back('\\');
-            ret.push_back('r');
-        } else if(c == ':') {
-            ret.push_back('\\');
-            ret.push_back(':');
-        } else if(c == '\\') {
-            ret.push_back('\\');
-            ret.push_back('\\');
-        } else {
-            ret.push_back(c);
+}
+
+bool needsEscape(char c) {
+    return c == '\n' || c == '\r' || c == ':' || c == '\\';
+}
+
+char escapeCode(char c) {
+    switch(c) {
+    case '\n':
+        return 'n';
+    case '\r':
+        return 'r';
+    case ':':
+        return 'c';
+    default:
+        return c;
+    }
+}
+
+#if defined(__SSE2__)
+/*  Bit mask of the bytes needing an escape sequence among the 16 bytes at chunk.
+ */
+int escapeMask(const char* chunk) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chunk) );
+    const __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n') ),
+                                                    _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r') ) ),
+                                       _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(':') ),
+                                                    _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\') ) ) );
+    return _mm_movemask_epi8(found);
+}
+#endif
+
+size_t escapedSize(std::string_view str) {
+    size_t size = str.size();
+    size_t i = 0;
+#if defined(__SSE2__)
+    for(; i + 16 <= str.size(); i += 16)
+        size += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(escapeMask(str.data() + i) ) ) );
+#endif
+    for(; i<str.size(); ++i)
+        size += needsEscape(str[i]);
+    return size;
+}
+
+/*  Write the escaped value at out, which must hold escapedSize(str) bytes, and return its end.
+ *
+ *  Runs of bytes without escape sequences are copied 16 bytes at a time where SSE2 is available.
+ */
+char* escapeTo(std::string_view str, char* out) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    while(i + 16 <= str.size() ) {
+        const int mask = escapeMask(str.data() + i);
+        const size_t plain = mask == 0 ? 16 : static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask) ) );
+        std::memcpy(out, str.data() + i, plain);
+        out += plain;
+        i += plain;
+        if(mask != 0) {
+            *out++ = '\\';
+            *out++ = escapeCode(str[i++]);
         }
     }
-    return ret;
+#endif
+    for(; i<str.size(); ++i) {
+        if(needsEscape(str[i]) )
+            *out++ = '\\';
+        *out++ = needsEscape(str[i]) ? escapeCode(str[i]) : str[i];
+    }
+    return out;
+}
+
+// The connection frames are never escaped, for compatibility with STOMP v1.0.
+bool isEscapedCommand(StompCommand sc) {
+    return sc != StompCommand::Stomp && sc != StompCommand::Connected;
 }
 
 
@@ -138,6 +269,155 @@ bool contains(std::initializer_list<StompCommand> lst, StompCommand sc) {
     return false;
 }
 
+/*  Size of a serialised frame. Headers is a sequence of (StompHeader, string) pairs.
+ */
+template <typename Headers>
+size_t frameSizeOf(StompCommand sc, const Headers& headers, std::string_view body) {
+    const bool escaped = isEscapedCommand(sc);
+    size_t size = toStringView(sc).size() + 1 + 1 + body.size() + 1;
+    for(const auto& [k,v] : headers) {
+        const std::string_view value{v};
+        size += toStringView(k).size() + 1 + (escaped ? escapedSize(value) : value.size() ) + 1;
+    }
+    return size;
+}
+
+/*  Serialise a frame at out, which must hold frameSizeOf() bytes, and return its end.
+ *
+ *  onHeader(header, value, size) is called with the position of each value as written.
+ */
+template <typename Headers, typename OnHeader>
+char* writeFrame(char* out, StompCommand sc, const Headers& headers, std::string_view body, OnHeader&& onHeader) {
+    const auto append = [&out](std::string_view str) {
+        std::memcpy(out, str.data(), str.size() );
+        out += str.size();
+    };
+    const bool escaped = isEscapedCommand(sc);
+    append(toStringView(sc) );
+    *out++ = '\n';
+    for(const auto& [k,v] : headers) {
+        const std::string_view value{v};
+        append(toStringView(k) );
+        *out++ = ':';
+        char* const valueBegin = out;
+        if(escaped)
+            out = escapeTo(value, out);
+        else
+            append(value);
+        onHeader(k, valueBegin, static_cast<size_t>(out - valueBegin) );
+        *out++ = '\n';
+    }
+    *out++ = '\n';
+    append(body);
+    *out++ = '\0';
+    return out;
+}
+
+/*  Check the body and the required headers of a frame.
+ *
+ *  findHeader(header) returns the (unescaped) value of a header, or std::nullopt.
+ */
+template <typename FindHeader>
+StompError validateFrame(StompCommand sc, size_t bodyLength, FindHeader&& findHeader) {
+    const auto has = [&findHeader](StompHeader sh) {
+        return findHeader(sh).has_value();
+    };
+
+    //Check body
+    if(!contains({StompCommand::Send, StompCommand::Message, StompCommand::Error}, sc) && bodyLength != 0)
+        return StompError::Validation;
+    if(const auto lenStr = findHeader(StompHeader::ContentLength) ) {
+        size_t len = 0;
+        const auto [end, err] = std::from_chars(lenStr->data(), lenStr->data() + lenStr->size(), len);
+        if(err != std::errc{} || end != lenStr->data() + lenStr->size() )
+            return StompError::Parsing;
+        if(bodyLength != len)
+            return StompError::Validation;
+    }
+
+    //Check required headers
+    switch(sc) {
+    case StompCommand::Stomp:
+        if(!has(StompHeader::AcceptVersion) ||
+           !has(StompHeader::Host) )
+        {
+            return StompError::Validation;
+        }
+    break;
+    case StompCommand::Connected:
+        if(!has(StompHeader::Version) )
+            return StompError::Validation;
+    break;
+    case StompCommand::Send:
+        if(!has(StompHeader::Destination) )
+            return StompError::Validation;
+    break;
+    case StompCommand::Subscribe:
+        if(!has(StompHeader::Destination) ||
+           !has(StompHeader::Id) )
+        {
+            return StompError::Validation;
+        }
+    break;
+    case StompCommand::Receipt:
+        if(!has(StompHeader::ReceiptId) )
+            return StompError::Validation;
+    break;
+    case StompCommand::Message:
+        if(!has(StompHeader::Destination) ||
+           !has(StompHeader::MessageId)   ||
+           !has(StompHeader::Subscription) )
+        {
+            return StompError::Validation;
+        }
+    break;
+    case StompCommand::Disconnect:
+    case StompCommand::Error:
+    break;
+    }
+
+    return StompError::Ok;
+}
+
+/*  Find the first occurrence of a header in a list given to StompFrameWriter.
+ */
+std::optional<std::string_view> findHeader(std::initializer_list<StompFrameWriter::Header> headers, StompHeader sh) {
+    for(const auto& [k,v] : headers) {
+        if(k == sh)
+            return v;
+    }
+    return std::nullopt;
+}
+
+
+/*  Find the first of the three characters in [first, last), or return last.
+ *
+ *  Header lines are scanned 16 bytes at a time where SSE2 is available.
+ */
+const char* findFirstOf(const char* first, const char* last, char a, char b, char c) {
+#if defined(__SSE2__)
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    while(last - first >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first) );
+        const __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, va),
+                                                        _mm_cmpeq_epi8(chunk, vb) ),
+                                           _mm_cmpeq_epi8(chunk, vc) );
+        const int mask = _mm_movemask_epi8(found);
+        if(mask != 0)
+            return first + __builtin_ctz(static_cast<unsigned>(mask) );
+        first += 16;
+    }
+#endif
+    for(; first != last; ++first) {
+        if(*first == a || *first == b || *first == c)
+            return first;
+    }
+    return last;
+}
+
+
 } //namespace
 
 std::ostream& operator<<(std::ostream& os, StompCommand sc) {
@@ -177,25 +457,19 @@ StompFrame::StompFrame(StompError& ec,
                        StompCommand sc,
                        std::unordered_map<StompHeader, std::string>&& headerMp,
                        std::string body) :
-    m_command{sc},
-    m_headerMp{std::move(headerMp)},
-    m_body{std::move(body)}
+    m_command{sc}
 {
+    m_frame.resize(frameSizeOf(m_command, headerMp, body) );
+    char* const begin = m_frame.data();
+    char* const end = writeFrame(begin, m_command, headerMp, body, [&](StompHeader sh, const char* value, size_t size) {
+        m_headers[static_cast<size_t>(sh)] = {
+            {static_cast<size_t>(value - begin), size},
+            size != headerMp.at(sh).size() ? HeaderState::Escaped : HeaderState::Plain
+        };
+    });
+    m_body = {static_cast<size_t>(end - begin) - 1 - body.size(), body.size()};
+
     ec = validation();
-    if(ec != StompError::Ok)
-        return;
-    std::stringstream ss;
-    ss << m_command << '\n';
-    for(const auto& [k,v] : m_headerMp) {
-        if(m_command == StompCommand::Stomp || m_command == StompCommand::Connected)
-            ss << k << ':' << v << '\n';
-        else
-            ss << k << ':' << escapeString(v) << '\n';
-    }
-    ss << '\n';
-    ss << m_body;
-    ss << '\0';
-    m_frame = ss.str();
 }
 
 StompCommand StompFrame::getCommand() const {
@@ -203,153 +477,192 @@ StompCommand StompFrame::getCommand() const {
 }
 
 bool StompFrame::hasHeader(StompHeader sh) const {
-    return m_headerMp.contains(sh);
+    return m_headers[static_cast<size_t>(sh)].state != HeaderState::Absent;
 }
 
 std::string_view StompFrame::getHeader(StompHeader sh) const {
-    if(!m_headerMp.contains(sh) )
-        throw std::invalid_argument("Unable to find header: " + std::string(toStringView(sh) ) );
-    return m_headerMp.at(sh);
+    const auto& header = m_headers[static_cast<size_t>(sh)];
+    switch(header.state) {
+    case HeaderState::Absent:
+        throw std::invalid_argument("Unable to find header: " + std::string(NetworkMonitor::toStringView(sh) ) );
+    case HeaderState::Plain:
+        return view(header.slice);
+    case HeaderState::Escaped:
+    {
+        // Decode every escaped header at once, so m_unescaped is filled by a single allocation
+        // and never reallocated afterwards.
+        size_t size = 0;
+        for(const auto& slot : m_headers)
+            size += slot.state == HeaderState::Escaped ? slot.slice.length : 0;
+        m_unescaped.reserve(size);
+        for(auto& slot : m_headers) {
+            if(slot.state != HeaderState::Escaped)
+                continue;
+            const size_t offset = m_unescaped.size();
+            unEscapeInto(view(slot.slice), m_unescaped);
+            slot = {{offset, m_unescaped.size() - offset}, HeaderState::Decoded};
+        }
+    }
+    [[fallthrough]];
+    case HeaderState::Decoded:
+        return std::string_view(m_unescaped).substr(header.slice.offset, header.slice.length);
+    }
+    throw std::logic_error("Unreachable: "s + __func__);
 }
 
 std::string_view StompFrame::getBody() const {
-    return m_body;
+    return view(m_body);
 }
 
 std::string StompFrame::toString() const {
     return m_frame;
 }
 
+std::string_view StompFrame::toStringView() const {
+    return m_frame;
+}
+
+std::string_view StompFrame::view(Slice slice) const {
+    return std::string_view(m_frame).substr(slice.offset, slice.length);
+}
+
+StompError StompFrame::setHeader(StompHeader sh, Slice value) {
+    auto& header = m_headers[static_cast<size_t>(sh)];
+    // Only the first occurrence of a repeated header is used.
+    if(header.state != HeaderState::Absent)
+        return StompError::Ok;
+    const auto raw = view(value);
+    if(!isEscapedCommand(m_command) || raw.find('\\') == std::string_view::npos) {
+        header = {value, HeaderState::Plain};
+        return StompError::Ok;
+    }
+    if(!isValidEscaped(raw) )
+        return StompError::Parsing;
+    header = {value, HeaderState::Escaped};
+    return StompError::Ok;
+}
+
 StompError StompFrame::parseFrame() {
-    namespace Parser = boost::spirit::x3;
-    const auto eol = -Parser::lit('\r') >> '\n';
-
-    constexpr auto clientCommand = Parser::string("SEND\n")
-                                 | Parser::string("SUBSCRIBE\n")
-                                 | Parser::string("UNSUBSCRIBE\n")
-                                 | Parser::string("BEGIN\n")
-                                 | Parser::string("COMMIT\n")
-                                 | Parser::string("ABORT\n")
-                                 | Parser::string("ACK\n")
-                                 | Parser::string("NACK\n")
-                                 | Parser::string("DISCONNECT\n")
-                                 | Parser::string("CONNECT\n")
-                                 | Parser::string("STOMP\n");
-    constexpr auto serverCommand = Parser::string("CONNECTED\n")
-                                 | Parser::string("MESSAGE\n")
-                                 | Parser::string("RECEIPT\n")
-                                 | Parser::string("ERROR\n");
-    const auto command = (clientCommand | serverCommand);
-
-    const auto invalidHeaderChar = Parser::lit(':') | '\r' | '\n';
-    const auto headerChar = Parser::char_ - invalidHeaderChar;
-    const auto headerName = +headerChar;
-    const auto headerValue = *headerChar;
-    const auto header = (headerName >> ':' >> headerValue);
-
-    const auto frame = command
-                        >> *(header >> eol)
-                        >> eol
-                        >> *Parser::char_;
-
-
-    std::tuple<std::string, std::vector<std::pair<std::string, std::string> >, std::string> parsed;
-    if(!Parser::parse(m_frame.cbegin(), m_frame.cend(), frame, parsed) )
-       return StompError::Parsing;
-
-    try {
-        std::get<0>(parsed).pop_back();
-        m_command = toStompCommand(std::get<0>(parsed) );
-
-        auto& headerLst = std::get<1>(parsed);
-        for(auto iter = headerLst.rbegin(); iter != headerLst.rend(); ++iter) {
-            auto headerName = toStompHeader(iter->first);
-            if(m_command == StompCommand::Stomp || m_command == StompCommand::Connected)
-                m_headerMp[headerName] = std::move(iter->second);
-            else
-                m_headerMp[headerName] = unEscapeString(std::move(iter->second) );
-        }
-    } catch (std::runtime_error& ex) {
-        std::cerr<<__func__<<":"<<__LINE__<<" : "<<ex.what()<<std::endl;
+    const char* const begin = m_frame.data();
+    const char* const end = begin + m_frame.size();
+
+    // Command line
+    const char* eol = static_cast<const char*>(std::memchr(begin, '\n', m_frame.size() ) );
+    if(eol == nullptr)
         return StompError::Parsing;
-    }
+    std::string_view command(begin, static_cast<size_t>(eol - begin) );
+    if(!command.empty() && command.back() == '\r')
+        command.remove_suffix(1);
+    const auto sc = toStompCommand(command);
+    if(!sc)
+        return StompError::Parsing;
+    m_command = *sc;
 
-    m_body = std::get<2>(parsed);
-    while(!m_body.empty() ) {
-        if(m_body.back() == '\n') {
-            m_body.pop_back();
-            if(!m_body.empty() && m_body.back() == '\r')
-                m_body.pop_back();
-        } else if(m_body.back() == '\0') {
+    // Header lines, up to the empty line
+    const char* pos = eol + 1;
+    while(true) {
+        if(pos == end)
+            return StompError::Parsing;
+        if(*pos == '\n') {
+            ++pos;
             break;
-        } else {
+        }
+        if(*pos == '\r' && pos + 1 != end && pos[1] == '\n') {
+            pos += 2;
+            break;
+        }
+
+        const char* const colon = findFirstOf(pos, end, ':', '\r', '\n');
+        if(colon == end || colon == pos || *colon != ':')
+            return StompError::Parsing;
+        const char* const valueEnd = findFirstOf(colon + 1, end, ':', '\r', '\n');
+        if(valueEnd == end || *valueEnd == ':')
             return StompError::Parsing;
+        const char* next = valueEnd + 1;
+        if(*valueEnd == '\r') {
+            if(next == end || *next != '\n')
+                return StompError::Parsing;
+            ++next;
         }
+
+        const auto header = toStompHeader(std::string_view(pos, static_cast<size_t>(colon - pos) ) );
+        if(!header)
+            return StompError::Parsing;
+        const auto ec = setHeader(*header, {static_cast<size_t>(colon + 1 - begin),
+                                            static_cast<size_t>(valueEnd - colon - 1)});
+        if(ec != StompError::Ok)
+            return ec;
+        pos = next;
+    }
+
+    // Body, up to the NULL octet. When the content-length is correct the body is skipped over,
+    // otherwise the first NULL octet ends it and validation() reports the mismatch.
+    const char* nul = nullptr;
+    if(hasHeader(StompHeader::ContentLength) ) {
+        const auto lenStr = getHeader(StompHeader::ContentLength);
+        size_t len = 0;
+        const auto [lenEnd, err] = std::from_chars(lenStr.data(), lenStr.data() + lenStr.size(), len);
+        if(err == std::errc{} && len < static_cast<size_t>(end - pos) && pos[len] == '\0')
+            nul = pos + len;
     }
-    if(m_body.empty() )
+    if(nul == nullptr)
+        nul = static_cast<const char*>(std::memchr(pos, '\0', static_cast<size_t>(end - pos) ) );
+    if(nul == nullptr)
         return StompError::Parsing;
-    m_body.pop_back();
+    m_body = {static_cast<size_t>(pos - begin), static_cast<size_t>(nul - pos)};
+
+    // Only EOLs can follow the NULL octet.
+    for(const char* iter = nul + 1; iter != end; ++iter) {
+        if(*iter == '\r' && iter + 1 != end)
+            ++iter;
+        if(*iter != '\n')
+            return StompError::Parsing;
+    }
 
     return validation();
 }
 
-StompError StompFrame::validation() {
-    //Check body
-    if(!contains({StompCommand::Send, StompCommand::Message, StompCommand::Error}, m_command) && !m_body.empty() )
-        return StompError::Validation;
-    if(m_headerMp.contains(StompHeader::ContentLength) ) {
-        const auto lenStr = m_headerMp[StompHeader::ContentLength];
-        try {
-            const int len = std::stoi(lenStr);
-            if(m_body.length() != len)
-                return StompError::Validation;
-        }  catch (const std::exception& ex) {
-            std::cerr<<__func__<<":"<<__LINE__<<" : "<<ex.what()<<std::endl;
-            return StompError::Parsing;
-        }
-    }
+StompError StompFrame::validation() const {
+    return validateFrame(m_command, m_body.length, [this](StompHeader sh) -> std::optional<std::string_view> {
+        if(!hasHeader(sh) )
+            return std::nullopt;
+        return getHeader(sh);
+    });
+}
 
-    //Check required headers
-    switch(m_command) {
-    case StompCommand::Stomp:
-        if(!m_headerMp.contains(StompHeader::AcceptVersion) ||
-           !m_headerMp.contains(StompHeader::Host) )
-        {
-            return StompError::Validation;
-        }
-    break;
-    case StompCommand::Connected:
-        if(!m_headerMp.contains(StompHeader::Version) )
-            return StompError::Validation;
-    break;
-    case StompCommand::Send:
-        if(!m_headerMp.contains(StompHeader::Destination) )
-            return StompError::Validation;
-    break;
-    case StompCommand::Subscribe:
-        if(!m_headerMp.contains(StompHeader::Destination) ||
-           !m_headerMp.contains(StompHeader::Id) )
-        {
-            return StompError::Validation;
-        }
-    break;
-    case StompCommand::Receipt:
-        if(!m_headerMp.contains(StompHeader::ReceiptId) )
-            return StompError::Validation;
-    break;
-    case StompCommand::Message:
-        if(!m_headerMp.contains(StompHeader::Destination) ||
-           !m_headerMp.contains(StompHeader::MessageId)   ||
-           !m_headerMp.contains(StompHeader::Subscription) )
-        {
-            return StompError::Validation;
-        }
-    break;
-    case StompCommand::Disconnect:
-    case StompCommand::Error:
-    break;
-    }
+size_t StompFrameWriter::frameSize(StompCommand sc, std::initializer_list<Header> headers, std::string_view body) {
+    return frameSizeOf(sc, headers, body);
+}
+
+StompError StompFrameWriter::write(std::string& out,
+                                   StompCommand sc,
+                                   std::initializer_list<Header> headers,
+                                   std::string_view body)
+{
+    const auto ec = validateFrame(sc, body.size(), [headers](StompHeader sh) {
+        return findHeader(headers, sh);
+    });
+    if(ec != StompError::Ok)
+        return ec;
+    const size_t offset = out.size();
+    out.resize(offset + frameSizeOf(sc, headers, body) );
+    writeFrame(out.data() + offset, sc, headers, body, [](auto&&...){});
+    return StompError::Ok;
+}
 
+StompError StompFrameWriter::write(boost::beast::flat_buffer& out,
+                                   StompCommand sc,
+                                   std::initializer_list<Header> headers,
+                                   std::string_view body)
+{
+    const auto ec = validateFrame(sc, body.size(), [headers](StompHeader sh) {
+        return findHeader(headers, sh);
+    });
+    if(ec != StompError::Ok)
+        return ec;
+    const size_t size = frameSizeOf(sc, headers, body);
+    writeFrame(static_cast<char*>(out.prepare(size).data() ), sc, headers, body, [](auto&&...){});
+    out.commit(size);
     return StompError::Ok;
 }
 
@@ -0,0 +1,199 @@
+#include <network_monitor/stomp_stream_parser.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+
+using std::string_view_literals::operator""sv;
+
+namespace NetworkMonitor {
+
+namespace  {
+
+constexpr size_t npos = std::string::npos;
+
+/*  Find the content-length announced in the header lines, or npos.
+ *  Only the first occurrence of the header is used, as in StompFrame.
+ */
+size_t findContentLength(std::string_view headers) {
+    constexpr auto name = "content-length:"sv;
+    size_t lineBegin = headers.find('\n');
+    while(lineBegin != npos && ++lineBegin < headers.size() ) {
+        const auto line = headers.substr(lineBegin, headers.find('\n', lineBegin) - lineBegin);
+        if(line.substr(0, name.size() ) == name) {
+            const auto value = line.substr(name.size() );
+            size_t len = 0;
+            const auto [end, err] = std::from_chars(value.data(), value.data() + value.size(), len);
+            return err == std::errc{} ? len : npos;
+        }
+        lineBegin = headers.find('\n', lineBegin);
+    }
+    return npos;
+}
+
+} // namespace
+
+StompStreamParser::StompStreamParser(FrameHandler onFrame, size_t maxFrameSize) :
+    m_onFrame{onFrame ? std::move(onFrame) : [](auto&&...){}},
+    m_maxFrameSize{maxFrameSize}
+{
+}
+
+StompError StompStreamParser::push(std::string_view chunk) {
+    // Drop the frames handed out by the previous push before buffering more.
+    if(m_frameBegin != 0) {
+        m_buffer.erase(0, m_frameBegin);
+        m_headersEnd -= std::min(m_headersEnd, m_frameBegin);
+        m_scanned -= std::min(m_scanned, m_frameBegin);
+        m_bodyEnd -= m_bodyEnd != npos ? std::min(m_bodyEnd, m_frameBegin) : 0;
+        m_frameBegin = 0;
+    }
+    m_buffer.append(chunk);
+    return parse();
+}
+
+StompError StompStreamParser::push(std::string&& chunk) {
+    if(bufferedSize() != 0)
+        return push(std::string_view(chunk) );
+    // Nothing is buffered: take over the chunk, so that a chunk holding a single frame is never copied.
+    m_buffer = std::move(chunk);
+    m_frameBegin = 0;
+    return parse();
+}
+
+StompError StompStreamParser::parse() {
+    while(true) {
+        switch(m_state) {
+        case State::Idle:
+            // Heart-beats are EOLs sent between frames.
+            while(m_frameBegin < m_buffer.size() &&
+                  (m_buffer[m_frameBegin] == '\n' || m_buffer[m_frameBegin] == '\r') )
+            {
+                ++m_frameBegin;
+            }
+            if(m_frameBegin == m_buffer.size() ) {
+                m_buffer.clear();
+                m_frameBegin = 0;
+                return StompError::Ok;
+            }
+            m_scanned = m_frameBegin;
+            m_state = State::Headers;
+        break;
+        case State::Headers:
+            if(!findHeadersEnd() )
+                return waitForMore();
+            if(m_headersEnd - m_frameBegin > m_maxFrameSize)
+                return discard();
+            m_state = State::Body;
+        break;
+        case State::Body:
+        {
+            const size_t frameEnd = findFrameEnd();
+            if(frameEnd == npos)
+                return waitForMore();
+            if(frameEnd - m_frameBegin > m_maxFrameSize)
+                return discard();
+            emitFrame(frameEnd);
+            m_state = State::Idle;
+        }
+        break;
+        }
+    }
+}
+
+void StompStreamParser::reset() {
+    m_buffer.clear();
+    m_state = State::Idle;
+    m_frameBegin = 0;
+    m_headersEnd = 0;
+    m_scanned = 0;
+    m_bodyEnd = npos;
+}
+
+size_t StompStreamParser::bufferedSize() const {
+    return m_buffer.size() - m_frameBegin;
+}
+
+StompError StompStreamParser::waitForMore() {
+    if(bufferedSize() <= m_maxFrameSize)
+        return StompError::Ok;
+    return discard();
+}
+
+StompError StompStreamParser::discard() {
+    reset();
+    return StompError::Parsing;
+}
+
+bool StompStreamParser::findHeadersEnd() {
+    // The headers end with an empty line: "\n\n" or "\n\r\n".
+    const char* const data = m_buffer.data();
+    const size_t size = m_buffer.size();
+    while(m_scanned < size) {
+        const auto* eol = static_cast<const char*>(std::memchr(data + m_scanned, '\n', size - m_scanned) );
+        if(eol == nullptr) {
+            m_scanned = size;
+            return false;
+        }
+        const size_t pos = static_cast<size_t>(eol - data);
+        if(pos + 1 < size && data[pos + 1] == '\n') {
+            m_headersEnd = pos + 2;
+        } else if(pos + 2 < size && data[pos + 1] == '\r' && data[pos + 2] == '\n') {
+            m_headersEnd = pos + 3;
+        } else if(pos + 1 == size || (pos + 2 == size && data[pos + 1] == '\r') ) {
+            // Wait for the bytes telling whether this is the empty line.
+            m_scanned = pos;
+            return false;
+        } else {
+            m_scanned = pos + 1;
+            continue;
+        }
+
+        const size_t len = findContentLength({data + m_frameBegin, m_headersEnd - m_frameBegin});
+        m_bodyEnd = len != npos && len <= m_maxFrameSize ? m_headersEnd + len : npos;
+        m_scanned = m_headersEnd;
+        return true;
+    }
+    return false;
+}
+
+size_t StompStreamParser::findFrameEnd() {
+    const size_t size = m_buffer.size();
+    if(m_bodyEnd != npos) {
+        if(m_bodyEnd >= size)
+            return npos;
+        if(m_buffer[m_bodyEnd] == '\0')
+            return m_bodyEnd + 1;
+        // A wrong content-length: delimit the frame with the NULL octet and let StompFrame report it.
+        m_bodyEnd = npos;
+    }
+    const auto* nul = static_cast<const char*>(std::memchr(m_buffer.data() + m_scanned, '\0', size - m_scanned) );
+    if(nul == nullptr) {
+        m_scanned = size;
+        return npos;
+    }
+    return static_cast<size_t>(nul - m_buffer.data() ) + 1;
+}
+
+void StompStreamParser::emitFrame(size_t frameEnd) {
+    std::string bytes{};
+    if(m_frameBegin == 0 && frameEnd == m_buffer.size() ) {
+        bytes = std::move(m_buffer);
+        m_buffer.clear();
+        frameEnd = 0;
+    } else {
+        bytes = m_buffer.substr(m_frameBegin, frameEnd - m_frameBegin);
+    }
+    StompError ec;
+    StompFrame frame{ec, std::move(bytes)};
+    m_frameBegin = frameEnd;
+    m_bodyEnd = npos;
+    m_onFrame(ec, std::move(frame) );
+}
+
+} //namespace NetworkMonitor
@@ -1,57 +1,626 @@
 
 #include <network_monitor/transport_network.hpp>
+#include <network_monitor/logger.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
-#include <set>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
 #include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 using std::size_t;
 
 namespace NetworkMonitor {
 
+namespace {
+
+// Dijkstra state for TransportNetwork::findFastestJourney, reused across searches.
+struct JourneySearch {
+    static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+    static constexpr unsigned long long unreached = std::numeric_limits<unsigned long long>::max();
+
+    // The time, stop and route of a stop waiting to be visited.
+    using Entry = std::tuple<unsigned long long, std::uint32_t, RouteIndex>;
+
+    std::vector<unsigned long long> times{};
+    std::vector<std::uint32_t> parents{};
+    std::vector<Entry> heap{};
+    std::vector<std::uint32_t> path{};
+
+    void reset(size_t stopCount) {
+        times.assign(stopCount, unreached);
+        parents.assign(stopCount, none);
+        heap.clear();
+    }
+
+    void relax(std::uint32_t stop, RouteIndex route, unsigned long long time, std::uint32_t parent) {
+        if(time >= times[stop])
+            return;
+        times[stop] = time;
+        parents[stop] = parent;
+        heap.emplace_back(time, stop, route);
+        std::push_heap(heap.begin(), heap.end(), std::greater<>{});
+    }
+};
+
+thread_local JourneySearch journeySearch{};
+
+// Per-station count changes of a batch of passenger events, reused across batches.
+struct PassengerDeltas {
+    std::vector<long long> deltas{};
+    std::vector<StationIndex> touched{};
+
+    void add(StationIndex station, long long delta) {
+        if(station >= deltas.size() )
+            deltas.resize(station + 1, 0);
+        if(deltas[station] == 0)
+            touched.push_back(station);
+        deltas[station] += delta;
+    }
+};
+
+thread_local PassengerDeltas passengerDeltas{};
+
+// Builds a network from the SAX events of a network layout JSON document.
+// Stations are added as soon as they are parsed, lines and travel times are kept for later.
+class LayoutSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+    struct TravelTime {
+        Id stationA{};
+        Id stationB{};
+        unsigned int time{};
+    };
+
+    std::vector<Line> lines{};
+    std::vector<TravelTime> travelTimes{};
+
+    explicit LayoutSaxHandler(TransportNetwork& network) :
+        m_network{network}
+    {}
+
+    bool isComplete() const {
+        return m_sections == (bit(Key::Stations) | bit(Key::Lines) | bit(Key::TravelTimes) );
+    }
+
+    bool null() override {
+        return true;
+    }
+
+    bool boolean(bool) override {
+        return true;
+    }
+
+    bool number_integer(number_integer_t val) override {
+        return number(static_cast<unsigned int>(val) );
+    }
+
+    bool number_unsigned(number_unsigned_t val) override {
+        return number(static_cast<unsigned int>(val) );
+    }
+
+    bool number_float(number_float_t, const string_t&) override {
+        return true;
+    }
+
+    bool binary(binary_t&) override {
+        return true;
+    }
+
+    bool string(string_t& val) override {
+        const Key key = keyAt(m_depth);
+        if(m_depth == itemDepth) {
+            switch(keyAt(sectionDepth) ) {
+            case Key::Stations:
+                if(key == Key::StationId)
+                    m_station.id = std::move(val);
+                else if(key == Key::Name)
+                    m_station.name = std::move(val);
+                break;
+            case Key::Lines:
+                if(key == Key::LineId)
+                    m_line.id = std::move(val);
+                else if(key == Key::Name)
+                    m_line.name = std::move(val);
+                break;
+            case Key::TravelTimes:
+                if(key == Key::StartStationId)
+                    m_travelTime.stationA = std::move(val);
+                else if(key == Key::EndStationId)
+                    m_travelTime.stationB = std::move(val);
+                break;
+            default:
+                break;
+            }
+            m_itemFields |= bit(key);
+        } else if(m_depth == routeDepth && inRoutes() ) {
+            if(key == Key::RouteId)
+                m_route.id = std::move(val);
+            else if(key == Key::Direction)
+                m_route.direction = std::move(val);
+            else if(key == Key::LineId)
+                m_route.lineId = std::move(val);
+            else if(key == Key::StartStationId)
+                m_route.startStationId = std::move(val);
+            else if(key == Key::EndStationId)
+                m_route.endStationId = std::move(val);
+            m_routeFields |= bit(key);
+        } else if(m_depth == routeDepth + 1 && inRoutes() && keyAt(routeDepth) == Key::RouteStops) {
+            m_route.stops.push_back(std::move(val) );
+        }
+        return true;
+    }
+
+    bool start_object(size_t) override {
+        ++m_depth;
+        if(m_depth == itemDepth) {
+            m_itemFields = 0;
+            m_station = {};
+            m_line = {};
+            m_travelTime = {};
+        } else if(m_depth == routeDepth && inRoutes() ) {
+            m_routeFields = 0;
+            m_route = {};
+        }
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        const Key key = toKey(val);
+        if(m_depth < m_keys.size() )
+            m_keys[m_depth] = key;
+        if(m_depth == sectionDepth)
+            m_sections |= bit(key) & (bit(Key::Stations) | bit(Key::Lines) | bit(Key::TravelTimes) );
+        return true;
+    }
+
+    bool end_object() override {
+        if(m_depth == itemDepth)
+            endItem();
+        else if(m_depth == routeDepth && inRoutes() )
+            endRoute();
+        --m_depth;
+        return true;
+    }
+
+    bool start_array(size_t) override {
+        ++m_depth;
+        if(m_depth == routeDepth + 1 && inRoutes() && keyAt(routeDepth) == Key::RouteStops)
+            m_routeFields |= bit(Key::RouteStops);
+        else if(m_depth == itemDepth + 1 && keyAt(itemDepth) == Key::Routes)
+            m_itemFields |= bit(Key::Routes);
+        return true;
+    }
+
+    bool end_array() override {
+        --m_depth;
+        return true;
+    }
+
+    // The parser passes its error by the base type. It is thrown as its concrete type, as
+    // nlohmann::json::parse does, so that callers catching parse_error still catch it.
+    bool parse_error(size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        if(const auto* error = dynamic_cast<const nlohmann::json::parse_error*>(&ex) )
+            throw *error;
+        // A number too large for a double.
+        if(const auto* error = dynamic_cast<const nlohmann::json::out_of_range*>(&ex) )
+            throw *error;
+        throw std::runtime_error(ex.what() );
+    }
+
+private:
+    enum class Key : unsigned {
+        Other,
+        Stations,
+        Lines,
+        TravelTimes,
+        StationId,
+        LineId,
+        RouteId,
+        Name,
+        Direction,
+        StartStationId,
+        EndStationId,
+        Routes,
+        RouteStops,
+        TravelTime,
+    };
+
+    // root object -> section array -> item object -> routes array -> route object -> stops array
+    static constexpr size_t sectionDepth = 1;
+    static constexpr size_t itemDepth = 3;
+    static constexpr size_t routeDepth = 5;
+
+    TransportNetwork& m_network;
+    size_t m_depth = 0;
+    std::array<Key, routeDepth + 1> m_keys{};
+    unsigned m_sections = 0;
+
+    unsigned m_itemFields = 0;
+    Station m_station{};
+    Line m_line{};
+    TravelTime m_travelTime{};
+
+    unsigned m_routeFields = 0;
+    Route m_route{};
+
+    static constexpr unsigned bit(Key key) {
+        return 1u << static_cast<unsigned>(key);
+    }
+
+    static Key toKey(std::string_view key) {
+        constexpr std::array<std::pair<std::string_view, Key>, 13> keyLookup{{
+            {"stations", Key::Stations},
+            {"lines", Key::Lines},
+            {"travel_times", Key::TravelTimes},
+            {"station_id", Key::StationId},
+            {"line_id", Key::LineId},
+            {"route_id", Key::RouteId},
+            {"name", Key::Name},
+            {"direction", Key::Direction},
+            {"start_station_id", Key::StartStationId},
+            {"end_station_id", Key::EndStationId},
+            {"routes", Key::Routes},
+            {"route_stops", Key::RouteStops},
+            {"travel_time", Key::TravelTime},
+        }};
+        for(const auto& [name, value] : keyLookup) {
+            if(name == key)
+                return value;
+        }
+        return Key::Other;
+    }
+
+    Key keyAt(size_t depth) const {
+        return depth < m_keys.size() ? m_keys[depth] : Key::Other;
+    }
+
+    bool inRoutes() const {
+        return keyAt(sectionDepth) == Key::Lines && keyAt(itemDepth) == Key::Routes;
+    }
+
+    bool number(unsigned int val) {
+        if(m_depth == itemDepth && keyAt(sectionDepth) == Key::TravelTimes && keyAt(itemDepth) == Key::TravelTime) {
+            m_travelTime.time = val;
+            m_itemFields |= bit(Key::TravelTime);
+        }
+        return true;
+    }
+
+    static void requireFields(unsigned fields, unsigned required, std::string_view what) {
+        if( (fields & required) != required)
+            throw std::runtime_error("Missing field in " + std::string(what) );
+    }
+
+    void endItem() {
+        switch(keyAt(sectionDepth) ) {
+        case Key::Stations:
+            requireFields(m_itemFields, bit(Key::StationId) | bit(Key::Name), "station");
+            if(!m_network.addStation(m_station) )
+                throw std::runtime_error("Unable to add station: " + m_station.id);
+            break;
+        case Key::Lines:
+            requireFields(m_itemFields, bit(Key::LineId) | bit(Key::Name) | bit(Key::Routes), "line");
+            lines.push_back(std::move(m_line) );
+            break;
+        case Key::TravelTimes:
+            requireFields(
+                m_itemFields,
+                bit(Key::StartStationId) | bit(Key::EndStationId) | bit(Key::TravelTime),
+                "travel time"
+            );
+            travelTimes.push_back(std::move(m_travelTime) );
+            break;
+        default:
+            break;
+        }
+    }
+
+    void endRoute() {
+        requireFields(
+            m_routeFields,
+            bit(Key::RouteId) | bit(Key::Direction) | bit(Key::StartStationId) |
+                bit(Key::EndStationId) | bit(Key::RouteStops),
+            "route"
+        );
+        m_line.routes.push_back(std::move(m_route) );
+    }
+};
+
+// Binary snapshot layout: a Header, `sectionCount` Sections, then the section data.
+// Every section starts on an 8-byte boundary and its offset is relative to the start of the file.
+// The checksum covers everything after the section table, padding included.
+namespace Snapshot {
+
+constexpr std::array<char, 8> magic{'L', 'T', 'N', 'M', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t version = 2;
+constexpr std::uint32_t byteOrderMark = 0x01020304;
+constexpr size_t alignment = 8;
+
+struct Header {
+    std::array<char, 8> magic{};
+    std::uint32_t version{};
+    std::uint32_t byteOrderMark{};
+    std::uint64_t sectionCount{};
+    std::uint64_t checksum{};
+};
+
+struct Section {
+    std::uint64_t offset{};
+    std::uint64_t size{};
+};
+
+// The order of the sections in the file.
+enum SectionId : size_t {
+    StationIdOffsets,
+    StationIdChars,
+    StationNameOffsets,
+    StationNameChars,
+    RouteIdOffsets,
+    RouteIdChars,
+    RouteLines,
+    LineIdOffsets,
+    LineIdChars,
+    RouteStopOffsets,
+    RouteStops,
+    RouteTravelTimes,
+    EdgeOffsets,
+    Edges,
+    EdgeRoutes,
+    StationRouteOffsets,
+    StationRoutes,
+    SectionCount,
+};
+
+// FNV-1a, 64 bits.
+class Checksum {
+public:
+    void update(const char* data, size_t size) {
+        for(size_t i=0; i<size; ++i) {
+            m_hash ^= static_cast<unsigned char>(data[i]);
+            m_hash *= 0x100000001b3ull;
+        }
+    }
+
+    std::uint64_t value() const {
+        return m_hash;
+    }
+
+private:
+    std::uint64_t m_hash = 0xcbf29ce484222325ull;
+};
+
+// A list of strings as one character array, plus the offset at which each string starts.
+struct StringTable {
+    std::vector<std::uint64_t> offsets{};
+    std::string chars{};
+
+    explicit StringTable(const std::vector<Id>& strings) {
+        offsets.reserve(strings.size() + 1);
+        offsets.push_back(0);
+        for(const auto& str : strings) {
+            chars += str;
+            offsets.push_back(chars.size() );
+        }
+    }
+};
+
+class Writer {
+public:
+    template <typename T>
+    void add(const std::vector<T>& data) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        m_data.emplace_back(reinterpret_cast<const char*>(data.data() ), data.size() * sizeof(T) );
+    }
+
+    void add(const std::string& data) {
+        m_data.emplace_back(data.data(), data.size() );
+    }
+
+    bool write(const std::filesystem::path& dst) const {
+        std::vector<Section> sections;
+        std::uint64_t offset = sizeof(Header) + m_data.size() * sizeof(Section);
+        for(const auto& data : m_data) {
+            sections.push_back({offset, data.size()});
+            offset += paddedSize(data.size() );
+        }
+
+        Checksum checksum;
+        for(const auto& data : m_data) {
+            checksum.update(data.data(), data.size() );
+            checksum.update(padding.data(), paddedSize(data.size() ) - data.size() );
+        }
+        const Header header{
+            .magic = magic,
+            .version = version,
+            .byteOrderMark = byteOrderMark,
+            .sectionCount = sections.size(),
+            .checksum = checksum.value(),
+        };
+
+        // A snapshot cut short by a crash or a full disk must not replace the previous one:
+        // the file is written next to the destination, then renamed over it.
+        std::filesystem::path tmp = dst;
+        tmp += ".tmp";
+        std::ofstream file{tmp, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header) );
+        file.write(reinterpret_cast<const char*>(sections.data() ), sections.size() * sizeof(Section) );
+        for(const auto& data : m_data) {
+            file.write(data.data(), data.size() );
+            file.write(padding.data(), paddedSize(data.size() ) - data.size() );
+        }
+        file.close();
+        std::error_code ec;
+        if(file)
+            std::filesystem::rename(tmp, dst, ec);
+        if(!file || ec) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr std::array<char, alignment> padding{};
+
+    std::vector<std::string_view> m_data{};
+
+    static size_t paddedSize(size_t size) {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+};
+
+class Reader {
+public:
+    // Check the header, section table and checksum of a mapped snapshot.
+    bool open(const char* data, size_t size) {
+        Header header;
+        if(size < sizeof(header) )
+            return false;
+        std::memcpy(&header, data, sizeof(header) );
+        if(header.magic != magic || header.version != version || header.byteOrderMark != byteOrderMark)
+            return false;
+        if(header.sectionCount != SectionCount || size < sizeof(Header) + SectionCount * sizeof(Section) )
+            return false;
+
+        m_sections.resize(SectionCount);
+        std::memcpy(m_sections.data(), data + sizeof(Header), SectionCount * sizeof(Section) );
+        const size_t dataBegin = sizeof(Header) + SectionCount * sizeof(Section);
+        for(const auto& section : m_sections) {
+            if(section.offset < dataBegin || section.offset % alignment != 0 ||
+               section.offset > size || section.size > size - section.offset)
+            {
+                return false;
+            }
+        }
+
+        Checksum checksum;
+        checksum.update(data + dataBegin, size - dataBegin);
+        if(checksum.value() != header.checksum)
+            return false;
+
+        m_data = data;
+        return true;
+    }
+
+    // The network owns its arrays, as travel times, stations and lines can change after loading:
+    // each section is copied out of the mapping in one go, without parsing.
+    template <typename T>
+    bool read(SectionId id, std::vector<T>& out) const {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const Section& section = m_sections[id];
+        if(section.size % sizeof(T) != 0)
+            return false;
+        out.resize(section.size / sizeof(T) );
+        if(section.size != 0)
+            std::memcpy(out.data(), m_data + section.offset, section.size);
+        return true;
+    }
+
+    bool readStrings(SectionId offsetsId, SectionId charsId, std::vector<Id>& out) const {
+        std::vector<std::uint64_t> offsets;
+        if(!read(offsetsId, offsets) || offsets.empty() || offsets.front() != 0)
+            return false;
+        const Section& chars = m_sections[charsId];
+        if(offsets.back() != chars.size || !std::is_sorted(offsets.begin(), offsets.end() ) )
+            return false;
+        out.clear();
+        out.reserve(offsets.size() - 1);
+        for(size_t i=0; i+1<offsets.size(); ++i)
+            out.emplace_back(m_data + chars.offset + offsets[i], offsets[i+1] - offsets[i]);
+        return true;
+    }
+
+private:
+    const char* m_data = nullptr;
+    std::vector<Section> m_sections{};
+};
+
+// Check a CSR offset array: `count` ranges covering [0, size) in order.
+bool isValidOffsets(const std::vector<std::uint32_t>& offsets, size_t count, size_t size) {
+    return offsets.size() == count + 1 && offsets.front() == 0 && offsets.back() == size &&
+           std::is_sorted(offsets.begin(), offsets.end() );
+}
+
+template <typename T, typename Index>
+bool isAllBelow(const std::vector<T>& values, Index T::* member, size_t bound) {
+    return std::all_of(values.begin(), values.end(), [member, bound](const T& value) {
+        return value.*member < bound;
+    });
+}
+
+bool isAllBelow(const std::vector<std::uint32_t>& values, size_t bound) {
+    return std::all_of(values.begin(), values.end(), [bound](std::uint32_t value) {
+        return value < bound;
+    });
+}
+
+} //namespace Snapshot
+
+} //namespace
+
 bool TransportNetwork::fromJson(nlohmann::json&& src) {
-    m_nodeMp = {};
+    *this = TransportNetwork{};
+
+    // The JSON object is ours, so its strings can be moved out rather than copied.
+    const auto take = [](nlohmann::json& item, const char* key) {
+        return std::move(item.at(key).get_ref<std::string&>() );
+    };
 
-    const auto& stations = src.at("stations");
-    for(const auto& stationJson : stations) {
+    auto& stations = src.at("stations");
+    for(auto& stationJson : stations) {
         const Station station{
-            .id = stationJson.at("station_id"),
-            .name = stationJson.at("name"),
+            .id = take(stationJson, "station_id"),
+            .name = take(stationJson, "name"),
         };
         if(!addStation(station) )
             throw std::runtime_error("Unable to add station: " + station.id);
     }
 
-    const auto& lines = src.at("lines");
-    for(const auto& lineJson : lines) {
+    auto& lines = src.at("lines");
+    for(auto& lineJson : lines) {
         Line line{
-            .id = lineJson.at("line_id"),
-            .name = lineJson.at("name"),
+            .id = take(lineJson, "line_id"),
+            .name = take(lineJson, "name"),
         };
-        const auto& lineJsonRoutes = lineJson.at("routes");
-        for(const auto& routeJson : lineJsonRoutes) {
+        auto& lineJsonRoutes = lineJson.at("routes");
+        for(auto& routeJson : lineJsonRoutes) {
             Route route {
-                .id = routeJson.at("route_id"),
-                .direction = routeJson.at("direction"),
-                .startStationId = routeJson.at("start_station_id"),
-                .endStationId = routeJson.at("end_station_id"),
+                .id = take(routeJson, "route_id"),
+                .direction = take(routeJson, "direction"),
+                .startStationId = take(routeJson, "start_station_id"),
+                .endStationId = take(routeJson, "end_station_id"),
             };
-            const auto& routeStops = routeJson.at("route_stops");
+            auto& routeStops = routeJson.at("route_stops");
+            route.stops.reserve(routeStops.size() );
             for(auto& station : routeStops) {
-                route.stops.push_back(station);
+                route.stops.push_back(std::move(station.get_ref<std::string&>() ) );
             }
             line.routes.push_back(std::move(route) );
         }
-        if(!addLine(line) )
+        // The adjacency is built once, after all the lines are in.
+        if(!insertLine(line) )
             throw std::runtime_error("Unable to add line: " + line.id);
     }
+    buildAdjacency();
 
-    const auto travelTimes = src.at("travel_times");
+    const auto& travelTimes = src.at("travel_times");
     for(const auto& travelTime : travelTimes) {
-        const Id stationA = travelTime.at("start_station_id");
-        const Id stationB = travelTime.at("end_station_id");
+        const auto& stationA = travelTime.at("start_station_id").get_ref<const std::string&>();
+        const auto& stationB = travelTime.at("end_station_id").get_ref<const std::string&>();
         const unsigned int time = travelTime.at("travel_time");
         if(!setTravelTime(stationA, stationB, time) )
             return false;
@@ -59,84 +628,248 @@ bool TransportNetwork::fromJson(nlohmann::json&& src) {
     return true;
 }
 
-bool TransportNetwork::addStation(const Station& station) {
-    return m_nodeMp.insert({
-        station.id,
-        Node{
-            .stationName = station.name,
-            .passengerCount = 0,
-            .outEdges = {},
-        }
-    }).second;
-}
+bool TransportNetwork::fromJsonStream(std::istream& src) {
+    *this = TransportNetwork{};
 
-bool TransportNetwork::addLine(const Line& line) {
-    for(const Route& route : line.routes) {
-        if(route.stops.size() < 2)
+    LayoutSaxHandler handler{*this};
+    nlohmann::json::sax_parse(src, &handler);
+    if(!handler.isComplete() )
+        throw std::runtime_error("Missing stations, lines or travel times");
+
+    for(const Line& line : handler.lines) {
+        if(!insertLine(line) )
+            throw std::runtime_error("Unable to add line: " + line.id);
+    }
+    buildAdjacency();
+
+    for(const auto& travelTime : handler.travelTimes) {
+        if(!setTravelTime(travelTime.stationA, travelTime.stationB, travelTime.time) )
             return false;
-        for(const auto& stationId : route.stops) {
-            if(!m_nodeMp.contains(stationId) )
-                return false;
-        }
+    }
+    return true;
+}
+
+bool TransportNetwork::fromJsonFile(const std::filesystem::path& src) {
+    std::ifstream file{src};
+    if(!file)
+        throw std::runtime_error("Unable to open file: " + src.string() );
+    return fromJsonStream(file);
+}
+
+bool TransportNetwork::saveSnapshot(const std::filesystem::path& dst) const {
+    const Snapshot::StringTable stationIds{m_stationIds};
+    const Snapshot::StringTable stationNames{m_stationNames};
+    const Snapshot::StringTable routeIds{m_routeIds};
+    const Snapshot::StringTable lineIds{m_lineIds};
+
+    // Same order as Snapshot::SectionId.
+    Snapshot::Writer writer;
+    writer.add(stationIds.offsets);
+    writer.add(stationIds.chars);
+    writer.add(stationNames.offsets);
+    writer.add(stationNames.chars);
+    writer.add(routeIds.offsets);
+    writer.add(routeIds.chars);
+    writer.add(m_routeLines);
+    writer.add(lineIds.offsets);
+    writer.add(lineIds.chars);
+    writer.add(m_routeStopOffsets);
+    writer.add(m_routeStops);
+    writer.add(m_routeTravelTimes);
+    writer.add(m_edgeOffsets);
+    writer.add(m_edges);
+    writer.add(m_edgeRoutes);
+    writer.add(m_stationRouteOffsets);
+    writer.add(m_stationRoutes);
+    return writer.write(dst);
+}
+
+bool TransportNetwork::loadSnapshot(const std::filesystem::path& src) {
+    namespace Interprocess = boost::interprocess;
 
-        for(size_t i=0; i+1<route.stops.size(); ++i) {
-            const Id& fromStationId = route.stops[i];
-            Node& fromNode = m_nodeMp[fromStationId];
-            const Id& toStationId = route.stops[i+1];
+    std::error_code ec;
+    if(!std::filesystem::is_regular_file(src, ec) || std::filesystem::file_size(src, ec) == 0)
+        return false;
 
-            Node& toNode = m_nodeMp[toStationId];
+    TransportNetwork nw{};
+    try {
+        const Interprocess::file_mapping file{src.c_str(), Interprocess::read_only};
+        const Interprocess::mapped_region region{file, Interprocess::read_only};
 
-            auto& outEdges = fromNode.outEdges[&toNode];
-            if(outEdges.routes.contains(route.id) )
+        using namespace Snapshot;
+        Reader reader;
+        if(!reader.open(static_cast<const char*>(region.get_address() ), region.get_size() ) )
+            return false;
+        const bool ok = reader.readStrings(StationIdOffsets, StationIdChars, nw.m_stationIds) &&
+                        reader.readStrings(StationNameOffsets, StationNameChars, nw.m_stationNames) &&
+                        reader.readStrings(RouteIdOffsets, RouteIdChars, nw.m_routeIds) &&
+                        reader.read(RouteLines, nw.m_routeLines) &&
+                        reader.readStrings(LineIdOffsets, LineIdChars, nw.m_lineIds) &&
+                        reader.read(RouteStopOffsets, nw.m_routeStopOffsets) &&
+                        reader.read(RouteStops, nw.m_routeStops) &&
+                        reader.read(RouteTravelTimes, nw.m_routeTravelTimes) &&
+                        reader.read(EdgeOffsets, nw.m_edgeOffsets) &&
+                        reader.read(Edges, nw.m_edges) &&
+                        reader.read(EdgeRoutes, nw.m_edgeRoutes) &&
+                        reader.read(StationRouteOffsets, nw.m_stationRouteOffsets) &&
+                        reader.read(StationRoutes, nw.m_stationRoutes);
+        if(!ok)
+            return false;
+    } catch(const std::exception& ex) {
+        logError(__func__, ":", __LINE__, ": ", ex.what());
+        return false;
+    }
+
+    // The checksum only catches accidental corruption, the indices must still be in range.
+    const size_t stationCount = nw.m_stationIds.size();
+    const size_t routeCount = nw.m_routeIds.size();
+    const bool consistent =
+        nw.m_stationNames.size() == stationCount &&
+        nw.m_routeLines.size() == routeCount &&
+        Snapshot::isAllBelow(nw.m_routeLines, nw.m_lineIds.size() ) &&
+        Snapshot::isValidOffsets(nw.m_routeStopOffsets, routeCount, nw.m_routeStops.size() ) &&
+        Snapshot::isAllBelow(nw.m_routeStops, stationCount) &&
+        nw.m_routeTravelTimes.size() == nw.m_routeStops.size() &&
+        Snapshot::isValidOffsets(nw.m_edgeOffsets, stationCount, nw.m_edges.size() ) &&
+        Snapshot::isAllBelow(nw.m_edges, &Edge::to, stationCount) &&
+        std::all_of(nw.m_edges.begin(), nw.m_edges.end(), [&nw](const Edge& edge) {
+            return edge.routesBegin <= edge.routesEnd && edge.routesEnd <= nw.m_edgeRoutes.size();
+        }) &&
+        Snapshot::isAllBelow(nw.m_edgeRoutes, routeCount) &&
+        Snapshot::isValidOffsets(nw.m_stationRouteOffsets, stationCount, nw.m_stationRoutes.size() ) &&
+        Snapshot::isAllBelow(nw.m_stationRoutes, &RouteStop::route, routeCount);
+    if(!consistent)
+        return false;
+    for(StationIndex station=0; station<stationCount; ++station) {
+        const auto begin = nw.m_stationRouteOffsets[station];
+        for(auto i = begin; i < nw.m_stationRouteOffsets[station + 1]; ++i) {
+            const RouteStop& stop = nw.m_stationRoutes[i];
+            const auto routeBegin = nw.m_routeStopOffsets[stop.route];
+            const auto routeEnd = nw.m_routeStopOffsets[stop.route + 1];
+            if(stop.position >= routeEnd - routeBegin || nw.m_routeStops[routeBegin + stop.position] != station)
+                return false;
+            // The stops are binary searched.
+            if(i != begin && !(nw.m_stationRoutes[i-1] < stop) )
                 return false;
-            outEdges.routes.insert(route.id);
-            toNode.inEdges[&fromNode] = outEdges;
         }
     }
+
+    for(StationIndex i=0; i<stationCount; ++i) {
+        if(!nw.m_stationIndexMp.insert({nw.m_stationIds[i], i}).second)
+            return false;
+    }
+    for(RouteIndex i=0; i<routeCount; ++i) {
+        if(!nw.m_routeIndexMp.insert({nw.m_routeIds[i], i}).second)
+            return false;
+    }
+    for(std::uint32_t i=0; i<nw.m_lineIds.size(); ++i)
+        nw.m_lineIndexMp.insert({nw.m_lineIds[i], i});
+    nw.m_passengerCounts.resize(stationCount);
+
+    *this = std::move(nw);
+    return true;
+}
+
+bool TransportNetwork::addStation(const Station& station) {
+    const auto index = static_cast<StationIndex>(m_stationIds.size() );
+    if(!m_stationIndexMp.insert({station.id, index}).second)
+        return false;
+    m_stationIds.push_back(station.id);
+    m_stationNames.push_back(station.name);
+    m_passengerCounts.emplace_back();
+    // A new station has no edges yet.
+    m_edgeOffsets.push_back(m_edgeOffsets.back() );
+    m_stationRouteOffsets.push_back(m_stationRouteOffsets.back() );
+    return true;
+}
+
+bool TransportNetwork::addLine(const Line& line) {
+    if(!insertLine(line) )
+        return false;
+    buildAdjacency();
     return true;
 }
 
 bool TransportNetwork::recordPassengerEvent(const PassengerEvent& event) {
-    if(!m_nodeMp.contains(event.stationId) )
+    const auto station = getStationIndex(event.stationId);
+    if(!station)
         return false;
 
-    auto& passengerCount = m_nodeMp[event.stationId].passengerCount;
+    // Each counter is independent, so relaxed ordering is enough.
+    auto& passengerCount = m_passengerCounts[*station].count;
     switch(event.type) {
     case PassengerEvent::Type::In:
-        ++passengerCount;
+        passengerCount.fetch_add(1, std::memory_order_relaxed);
         return true;
     case PassengerEvent::Type::Out:
-        --passengerCount;
+        passengerCount.fetch_sub(1, std::memory_order_relaxed);
         return true;
     }
     return false;
 }
 
+std::vector<size_t> TransportNetwork::recordPassengerEvents(const std::vector<PassengerEvent>& events) {
+    std::vector<size_t> failed;
+    PassengerDeltas& batch = passengerDeltas;
+
+    // Consecutive events often come from the same station, so skip the lookup for those.
+    const Id* lastId = nullptr;
+    std::optional<StationIndex> lastStation;
+    for(size_t i=0; i<events.size(); ++i) {
+        const PassengerEvent& event = events[i];
+        if(!lastId || *lastId != event.stationId) {
+            lastId = &event.stationId;
+            lastStation = getStationIndex(event.stationId);
+        }
+        if(!lastStation) {
+            failed.push_back(i);
+            continue;
+        }
+        switch(event.type) {
+        case PassengerEvent::Type::In:
+            batch.add(*lastStation, 1);
+            break;
+        case PassengerEvent::Type::Out:
+            batch.add(*lastStation, -1);
+            break;
+        default:
+            failed.push_back(i);
+            break;
+        }
+    }
+
+    // A station may go back to a zero delta after being touched, or be touched twice.
+    for(const StationIndex station : batch.touched) {
+        const long long delta = std::exchange(batch.deltas[station], 0);
+        if(delta != 0)
+            m_passengerCounts[station].count.fetch_add(delta, std::memory_order_relaxed);
+    }
+    batch.touched.clear();
+    return failed;
+}
+
 long long TransportNetwork::getPassengerCount(const Id& station) const {
-    if(!m_nodeMp.contains(station) )
+    const auto index = getStationIndex(station);
+    if(!index)
         throw std::runtime_error("Station is not found in network: " + station);
-    return m_nodeMp.at(station).passengerCount;
+    return m_passengerCounts[*index].count.load(std::memory_order_relaxed);
 }
 
 std::vector<Id> TransportNetwork::getRoutesServingStation(const Id& station) const {
-    if(!m_nodeMp.contains(station) )
+    const auto index = getStationIndex(station);
+    if(!index)
         return {};
 
-    const auto& node = m_nodeMp.at(station);
-    std::set<Id> routeSet;
-    for(const auto& [_, edge] : node.outEdges) {
-        for(const auto& route : edge.routes)
-            routeSet.insert(route);
-    }
-    for(const auto& [_, edge] : node.inEdges) {
-        for(const auto& route : edge.routes)
-            routeSet.insert(route);
-    }
-
+    const auto begin = m_stationRouteOffsets[*index];
+    const auto end = m_stationRouteOffsets[*index + 1];
     std::vector<Id> routeLst;
-    routeLst.reserve(routeSet.size() );
-    for(const auto& route : routeSet)
-        routeLst.push_back(route);
+    routeLst.reserve(end - begin);
+    for(auto i = begin; i < end; ++i) {
+        // The stops of a circular route at the same station are next to each other.
+        if(i == begin || m_stationRoutes[i].route != m_stationRoutes[i-1].route)
+            routeLst.push_back(m_routeIds[m_stationRoutes[i].route]);
+    }
+    std::sort(routeLst.begin(), routeLst.end() );
     return routeLst;
 }
 
@@ -145,72 +878,366 @@ bool TransportNetwork::setTravelTime(
         const Id& stationB,
         const unsigned int travelTime)
 {
-    if(!m_nodeMp.contains(stationA) || !m_nodeMp.contains(stationB) )
+    const auto indexA = getStationIndex(stationA);
+    const auto indexB = getStationIndex(stationB);
+    if(!indexA || !indexB)
         return false;
 
-    auto& nodeA = m_nodeMp[stationA];
-    auto& nodeB = m_nodeMp[stationB];
-
     bool adjacent = false;
-    if(nodeA.outEdges.contains(&nodeB) ) { // A->B
-        nodeA.outEdges.at(&nodeB).travelTime = travelTime;
-        nodeB.inEdges.at(&nodeA).travelTime = travelTime;
+    if(Edge* edge = findEdge(*indexA, *indexB) ) { // A->B
+        const unsigned int oldTravelTime = std::exchange(edge->travelTime, travelTime);
+        updateRouteTravelTimes(*indexA, *edge, oldTravelTime);
         adjacent = true;
     }
-    if(nodeA.inEdges.contains(&nodeB) ) { // B->A
-        nodeA.inEdges.at(&nodeB).travelTime = travelTime;
-        nodeB.outEdges.at(&nodeA).travelTime = travelTime;
+    if(Edge* edge = findEdge(*indexB, *indexA) ) { // B->A
+        const unsigned int oldTravelTime = std::exchange(edge->travelTime, travelTime);
+        updateRouteTravelTimes(*indexB, *edge, oldTravelTime);
         adjacent = true;
     }
-    if(!adjacent)
-        return false;
-
-    return true;
+    return adjacent;
 }
 
 unsigned int TransportNetwork::getAdjacentTravelTime(const Id& stationA, const Id& stationB) const {
-    if(!m_nodeMp.contains(stationA) || !m_nodeMp.contains(stationB) )
-        return 0;
-
-    const auto& nodeA = m_nodeMp.at(stationA);
-    const auto& nodeB = m_nodeMp.at(stationB);
-    if(nodeA.outEdges.contains(&nodeB) ) { // A->B
-        return nodeA.outEdges.at(&nodeB).travelTime;
-    } else if(nodeA.inEdges.contains(&nodeB) ) { // B->A
-        return nodeA.inEdges.at(&nodeB).travelTime;
-    } else { //not adjacent
+    const auto indexA = getStationIndex(stationA);
+    const auto indexB = getStationIndex(stationB);
+    if(!indexA || !indexB)
         return 0;
-    }
+    return getAdjacentTravelTime(*indexA, *indexB);
 }
 
-//TODO: Fix bugs
 unsigned int TransportNetwork::getTravelTime(
         const Id&,
         const Id& route,
         const Id& stationA,
         const Id& stationB) const
 {
-    if(!m_nodeMp.contains(stationA) || !m_nodeMp.contains(stationB) )
+    const auto routeIndex = getRouteIndex(route);
+    const auto indexA = getStationIndex(stationA);
+    const auto indexB = getStationIndex(stationB);
+    if(!routeIndex || !indexA || !indexB)
         return 0;
+    return getTravelTime(*routeIndex, *indexA, *indexB);
+}
 
-    const auto* from = &m_nodeMp.at(stationA);
-    const auto& to = m_nodeMp.at(stationB);
-
-    int travelTime = 0;
-    while(from != &to) {
-        bool foundRoute = false;
-        for(const auto& [next, edge]: from->outEdges) {
-            if(edge.routes.contains(route) ) {
-                travelTime += edge.travelTime;
-                from = next;
-                foundRoute = true;
-                break;
-            }
+std::vector<JourneyLeg> TransportNetwork::findFastestJourney(
+        const Id& from,
+        const Id& to,
+        unsigned int lineChangePenalty) const
+{
+    const auto fromIndex = getStationIndex(from);
+    const auto toIndex = getStationIndex(to);
+    if(!fromIndex || !toIndex || *fromIndex == *toIndex)
+        return {};
+
+    // The search runs over route stops: riding moves to the next stop of the same route,
+    // changing moves to another route stopping at the same station.
+    JourneySearch& search = journeySearch;
+    search.reset(m_routeStops.size() );
+
+    const auto stopsAt = [this](StationIndex station) {
+        return std::pair{
+            m_stationRoutes.begin() + m_stationRouteOffsets[station],
+            m_stationRoutes.begin() + m_stationRouteOffsets[station + 1],
+        };
+    };
+    const auto [fromBegin, fromEnd] = stopsAt(*fromIndex);
+    for(auto iter = fromBegin; iter != fromEnd; ++iter)
+        search.relax(m_routeStopOffsets[iter->route] + iter->position, iter->route, 0, JourneySearch::none);
+
+    std::uint32_t destination = JourneySearch::none;
+    while(!search.heap.empty() ) {
+        std::pop_heap(search.heap.begin(), search.heap.end(), std::greater<>{});
+        const auto [time, stop, route] = search.heap.back();
+        search.heap.pop_back();
+        if(time > search.times[stop])
+            continue;
+
+        const StationIndex station = m_routeStops[stop];
+        if(station == *toIndex) {
+            destination = stop;
+            break;
+        }
+
+        if(stop + 1 < m_routeStopOffsets[route + 1]) {
+            const auto rideTime = m_routeTravelTimes[stop + 1] - m_routeTravelTimes[stop];
+            search.relax(stop + 1, route, time + rideTime, stop);
+        }
+
+        const auto [changeBegin, changeEnd] = stopsAt(station);
+        for(auto iter = changeBegin; iter != changeEnd; ++iter) {
+            if(iter->route == route)
+                continue;
+            const auto changeTime = m_routeLines[iter->route] != m_routeLines[route] ? lineChangePenalty : 0;
+            search.relax(m_routeStopOffsets[iter->route] + iter->position, iter->route, time + changeTime, stop);
+        }
+    }
+    if(destination == JourneySearch::none)
+        return {};
+
+    search.path.clear();
+    for(auto stop = destination; stop != JourneySearch::none; stop = search.parents[stop])
+        search.path.push_back(stop);
+    std::reverse(search.path.begin(), search.path.end() );
+
+    // Consecutive stops on the same route make a leg, route changes in between are not legs.
+    std::vector<JourneyLeg> legs;
+    for(size_t begin=0, end=0; begin<search.path.size(); begin=end) {
+        const RouteIndex route = getRouteOfStop(search.path[begin]);
+        end = begin + 1;
+        while(end < search.path.size() && search.path[end] == search.path[end-1] + 1 &&
+              getRouteOfStop(search.path[end]) == route)
+        {
+            ++end;
+        }
+        if(end - begin < 2)
+            continue;
+        const auto firstStop = search.path[begin];
+        const auto lastStop = search.path[end-1];
+        legs.push_back({
+            .lineId = m_lineIds[m_routeLines[route]],
+            .routeId = m_routeIds[route],
+            .startStationId = m_stationIds[m_routeStops[firstStop]],
+            .endStationId = m_stationIds[m_routeStops[lastStop]],
+            .travelTime = m_routeTravelTimes[lastStop] - m_routeTravelTimes[firstStop],
+        });
+    }
+    return legs;
+}
+
+std::optional<StationIndex> TransportNetwork::getStationIndex(const Id& station) const {
+    const auto iter = m_stationIndexMp.find(station);
+    if(iter == m_stationIndexMp.end() )
+        return std::nullopt;
+    return iter->second;
+}
+
+std::optional<RouteIndex> TransportNetwork::getRouteIndex(const Id& route) const {
+    const auto iter = m_routeIndexMp.find(route);
+    if(iter == m_routeIndexMp.end() )
+        return std::nullopt;
+    return iter->second;
+}
+
+unsigned int TransportNetwork::getAdjacentTravelTime(StationIndex stationA, StationIndex stationB) const {
+    if(const Edge* edge = findEdge(stationA, stationB) ) // A->B
+        return edge->travelTime;
+    if(const Edge* edge = findEdge(stationB, stationA) ) // B->A
+        return edge->travelTime;
+    return 0; //not adjacent
+}
+
+unsigned int TransportNetwork::getTravelTime(
+        RouteIndex route,
+        StationIndex stationA,
+        StationIndex stationB) const
+{
+    if(stationA == stationB)
+        return 0;
+
+    // A route usually stops once at each station. On a circular route, ride from any stop at A
+    // to the next stop at B, and keep the shortest. Both ranges are sorted by position.
+    const auto routeBegin = m_routeStopOffsets[route];
+    const auto [beginA, endA] = findRouteStops(stationA, route);
+    const auto [beginB, endB] = findRouteStops(stationB, route);
+    std::optional<unsigned int> travelTime;
+    auto stopB = beginB;
+    for(auto stopA = beginA; stopA != endA; ++stopA) {
+        while(stopB != endB && stopB->position <= stopA->position)
+            ++stopB;
+        if(stopB == endB)
+            break;
+        const auto time = m_routeTravelTimes[routeBegin + stopB->position] - m_routeTravelTimes[routeBegin + stopA->position];
+        travelTime = std::min(travelTime.value_or(time), time);
+    }
+    return travelTime.value_or(0);
+}
+
+bool TransportNetwork::insertLine(const Line& line) {
+    // Validate the whole line first, so that a bad line leaves the network untouched.
+    for(size_t i=0; i<line.routes.size(); ++i) {
+        const Route& route = line.routes[i];
+        if(route.stops.size() < 2)
+            return false;
+        if(m_routeIndexMp.contains(route.id) )
+            return false;
+        for(size_t j=0; j<i; ++j) {
+            if(line.routes[j].id == route.id)
+                return false;
         }
-        if(!foundRoute)
-            return 0;
+        for(const auto& stationId : route.stops) {
+            if(!m_stationIndexMp.contains(stationId) )
+                return false;
+        }
+        // A route can come back to a stop, but not ride the same hop twice.
+        std::vector<std::pair<Id, Id> > hops;
+        hops.reserve(route.stops.size() - 1);
+        for(size_t j=0; j+1<route.stops.size(); ++j)
+            hops.emplace_back(route.stops[j], route.stops[j+1]);
+        std::sort(hops.begin(), hops.end() );
+        if(std::adjacent_find(hops.begin(), hops.end() ) != hops.end() )
+            return false;
+    }
+
+    const auto lineIndex = m_lineIndexMp.insert({line.id, static_cast<std::uint32_t>(m_lineIds.size() )}).first->second;
+    if(lineIndex == m_lineIds.size() )
+        m_lineIds.push_back(line.id);
+
+    for(const Route& route : line.routes) {
+        const auto routeIndex = static_cast<RouteIndex>(m_routeIds.size() );
+        m_routeIndexMp.insert({route.id, routeIndex});
+        m_routeIds.push_back(route.id);
+        m_routeLines.push_back(lineIndex);
+        for(const auto& stationId : route.stops) {
+            m_routeStops.push_back(m_stationIndexMp.at(stationId) );
+            m_routeTravelTimes.push_back(0);
+        }
+        m_routeStopOffsets.push_back(static_cast<std::uint32_t>(m_routeStops.size() ) );
+    }
+    return true;
+}
+
+void TransportNetwork::buildAdjacency() {
+    const size_t stationCount = m_stationIds.size();
+    const size_t routeCount = m_routeIds.size();
+
+    std::vector<RouteHop> routeHops;
+    routeHops.reserve(m_routeStops.size() );
+    for(RouteIndex route=0; route<routeCount; ++route) {
+        for(auto i = m_routeStopOffsets[route]; i+1 < m_routeStopOffsets[route+1]; ++i)
+            routeHops.push_back({m_routeStops[i], m_routeStops[i+1], route});
+    }
+    std::sort(routeHops.begin(), routeHops.end(), [](const RouteHop& lhs, const RouteHop& rhs) {
+        return std::tie(lhs.from, lhs.to, lhs.route) < std::tie(rhs.from, rhs.to, rhs.route);
+    });
+
+    // The hops are sorted by origin, so the edges come out already grouped per station.
+    std::vector<std::uint32_t> edgeOffsets(stationCount + 1, 0);
+    std::vector<Edge> edges;
+    std::vector<RouteIndex> edgeRoutes;
+    edgeRoutes.reserve(routeHops.size() );
+    for(size_t i=0; i<routeHops.size(); ++i) {
+        const RouteHop& hop = routeHops[i];
+        if(i == 0 || routeHops[i-1].from != hop.from || routeHops[i-1].to != hop.to) {
+            // Travel times survive a rebuild, and are the same in both directions.
+            const Edge* oldEdge = findEdge(hop.from, hop.to);
+            if(!oldEdge)
+                oldEdge = findEdge(hop.to, hop.from);
+            edges.push_back({
+                .to = hop.to,
+                .travelTime = oldEdge ? oldEdge->travelTime : 0,
+                .routesBegin = static_cast<std::uint32_t>(edgeRoutes.size() ),
+                .routesEnd = static_cast<std::uint32_t>(edgeRoutes.size() ),
+            });
+            ++edgeOffsets[hop.from + 1];
+        }
+        edgeRoutes.push_back(hop.route);
+        ++edges.back().routesEnd;
+    }
+    for(size_t i=0; i<stationCount; ++i)
+        edgeOffsets[i+1] += edgeOffsets[i];
+
+    std::vector<std::pair<StationIndex, RouteStop> > stationRoutePairs;
+    stationRoutePairs.reserve(m_routeStops.size() );
+    for(RouteIndex route=0; route<routeCount; ++route) {
+        const auto routeBegin = m_routeStopOffsets[route];
+        for(auto i = routeBegin; i < m_routeStopOffsets[route+1]; ++i)
+            stationRoutePairs.push_back({m_routeStops[i], {route, i - routeBegin}});
+    }
+    std::sort(stationRoutePairs.begin(), stationRoutePairs.end(), [](const auto& lhs, const auto& rhs) {
+        if(lhs.first != rhs.first)
+            return lhs.first < rhs.first;
+        return lhs.second < rhs.second;
+    });
+    std::vector<std::uint32_t> stationRouteOffsets(stationCount + 1, 0);
+    std::vector<RouteStop> stationRoutes;
+    stationRoutes.reserve(stationRoutePairs.size() );
+    for(const auto& [station, routeStop] : stationRoutePairs) {
+        ++stationRouteOffsets[station + 1];
+        stationRoutes.push_back(routeStop);
+    }
+    for(size_t i=0; i<stationCount; ++i)
+        stationRouteOffsets[i+1] += stationRouteOffsets[i];
+
+    m_edgeOffsets = std::move(edgeOffsets);
+    m_edges = std::move(edges);
+    m_edgeRoutes = std::move(edgeRoutes);
+    m_stationRouteOffsets = std::move(stationRouteOffsets);
+    m_stationRoutes = std::move(stationRoutes);
+
+    for(RouteIndex route=0; route<routeCount; ++route) {
+        const auto routeBegin = m_routeStopOffsets[route];
+        m_routeTravelTimes[routeBegin] = 0;
+        for(auto i = routeBegin + 1; i < m_routeStopOffsets[route+1]; ++i)
+            m_routeTravelTimes[i] = m_routeTravelTimes[i-1] + findEdge(m_routeStops[i-1], m_routeStops[i])->travelTime;
+    }
+}
+
+const TransportNetwork::Edge* TransportNetwork::findEdge(StationIndex from, StationIndex to) const {
+    if(from + 1 >= m_edgeOffsets.size() )
+        return nullptr;
+    const auto begin = m_edges.begin() + m_edgeOffsets[from];
+    const auto end = m_edges.begin() + m_edgeOffsets[from + 1];
+    const auto edge = std::find_if(begin, end, [to](const Edge& e) { return e.to == to; });
+    return edge == end ? nullptr : &*edge;
+}
+
+TransportNetwork::Edge* TransportNetwork::findEdge(StationIndex from, StationIndex to) {
+    return const_cast<Edge*>(std::as_const(*this).findEdge(from, to) );
+}
+
+std::pair<const TransportNetwork::RouteStop*, const TransportNetwork::RouteStop*> TransportNetwork::findRouteStops(
+        StationIndex station,
+        RouteIndex route) const
+{
+    if(station + 1 >= m_stationRouteOffsets.size() )
+        return {nullptr, nullptr};
+    const RouteStop* begin = m_stationRoutes.data() + m_stationRouteOffsets[station];
+    const RouteStop* end = m_stationRoutes.data() + m_stationRouteOffsets[station + 1];
+    return std::equal_range(begin, end, RouteStop{route, 0}, [](const RouteStop& lhs, const RouteStop& rhs) {
+        return lhs.route < rhs.route;
+    });
+}
+
+const TransportNetwork::RouteStop* TransportNetwork::findRouteStop(
+        StationIndex station,
+        RouteIndex route,
+        std::uint32_t minPosition) const
+{
+    const auto [begin, end] = findRouteStops(station, route);
+    const RouteStop* routeStop = std::lower_bound(begin, end, RouteStop{route, minPosition});
+    return routeStop == end ? nullptr : routeStop;
+}
+
+// The stop at `to` that a route reaches by riding from `from`, if the route has that hop.
+const TransportNetwork::RouteStop* TransportNetwork::findHop(
+        StationIndex from,
+        StationIndex to,
+        RouteIndex route) const
+{
+    const auto routeBegin = m_routeStopOffsets[route];
+    for(const RouteStop* stop = findRouteStop(to, route, 1); stop; stop = findRouteStop(to, route, stop->position + 1) ) {
+        if(m_routeStops[routeBegin + stop->position - 1] == from)
+            return stop;
+    }
+    return nullptr;
+}
+
+RouteIndex TransportNetwork::getRouteOfStop(std::uint32_t stop) const {
+    const auto iter = std::upper_bound(m_routeStopOffsets.begin(), m_routeStopOffsets.end(), stop);
+    return static_cast<RouteIndex>(iter - m_routeStopOffsets.begin() - 1);
+}
+
+void TransportNetwork::updateRouteTravelTimes(StationIndex from, const Edge& edge, unsigned int oldTravelTime) {
+    // The edge ends at `edge.to`: every stop from there onwards, on every route using the edge, shifts.
+    // A route rides a hop at most once, even when it comes back to a station.
+    for(auto i = edge.routesBegin; i < edge.routesEnd; ++i) {
+        const RouteIndex route = m_edgeRoutes[i];
+        const RouteStop* stop = findHop(from, edge.to, route);
+        if(!stop)
+            continue;
+        for(auto j = m_routeStopOffsets[route] + stop->position; j < m_routeStopOffsets[route+1]; ++j)
+            m_routeTravelTimes[j] = m_routeTravelTimes[j] - oldTravelTime + edge.travelTime;
     }
-    return travelTime;
 }
 
 } //NetworkMonitor
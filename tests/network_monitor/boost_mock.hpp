@@ -8,6 +8,7 @@
 #include <boost/utility/string_view.hpp>
 
 #include <string>
+#include <vector>
 
 namespace NetworkMonitor {
 
@@ -23,6 +24,15 @@ public:
      */
     static boost::system::error_code s_resolveEc;
 
+    /*! \brief Use this static member in a test to set the endpoints returned by
+     *         a successful async_resolve.
+     */
+    static std::vector<boost::asio::ip::tcp::endpoint> s_endpoints;
+
+    /*! \brief The number of calls to async_resolve.
+     */
+    static size_t s_resolveCount;
+
     /*! \brief Mock for the resolver constructor
      */
     template <typename ExecutionContext>
@@ -47,6 +57,7 @@ public:
             void (const boost::system::error_code&, resolver::results_type)
         >(
             [](auto&& handler, auto resolver, auto host, auto service) {
+                ++MockResolver::s_resolveCount;
                 if (MockResolver::s_resolveEc) {
                     // Failing branch.
                     boost::asio::post(
@@ -68,12 +79,8 @@ public:
                             //       resolver interface but it is not
                             //       documented.
                             resolver::results_type::create(
-                                boost::asio::ip::tcp::endpoint {
-                                    boost::asio::ip::make_address(
-                                        "127.0.0.1"
-                                    ),
-                                    443
-                                },
+                                MockResolver::s_endpoints.begin(),
+                                MockResolver::s_endpoints.end(),
                                 host,
                                 service
                             )
@@ -96,6 +103,10 @@ private:
 
 // Out-of-line static member initialization
 inline boost::system::error_code MockResolver::s_resolveEc {};
+inline std::vector<boost::asio::ip::tcp::endpoint> MockResolver::s_endpoints {
+    {boost::asio::ip::make_address("127.0.0.1"), 443}
+};
+inline size_t MockResolver::s_resolveCount {0};
 
 /*! \brief Mock the TCP socket stream from Boost.Beast.
  *
@@ -0,0 +1,91 @@
+#include <network_monitor/io_context_pool.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::IoContextPool;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_IoContextPool);
+
+BOOST_AUTO_TEST_CASE(default_size)
+{
+    IoContextPool pool {};
+    BOOST_CHECK_EQUAL(pool.size(), std::max(std::thread::hardware_concurrency(), 1u) );
+}
+
+BOOST_AUTO_TEST_CASE(round_robin)
+{
+    IoContextPool pool {3, false};
+    BOOST_REQUIRE_EQUAL(pool.size(), 3);
+    for (size_t i {0}; i < 7; ++i) {
+        BOOST_CHECK_EQUAL(&pool.next(), &pool.at(i % 3) );
+    }
+    BOOST_CHECK_THROW(pool.at(3), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(for_key)
+{
+    IoContextPool pool {4, false};
+    const auto& passengers {pool.forKey("/passengers")};
+    BOOST_CHECK_EQUAL(&pool.forKey("/passengers"), &passengers);
+
+    // Keys are spread over the contexts.
+    std::set<const boost::asio::io_context*> used {};
+    for (size_t i {0}; i < 64; ++i) {
+        used.insert(&pool.forKey("/network-events/" + std::to_string(i) ) );
+    }
+    BOOST_CHECK_EQUAL(used.size(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(one_thread_per_context, *boost::unit_test::timeout {1})
+{
+    IoContextPool pool {3};
+    pool.run();
+
+    // Every handler of a context runs on the same thread, and each context
+    // has its own.
+    std::vector<std::thread::id> threads {};
+    for (size_t i {0}; i < pool.size(); ++i) {
+        std::set<std::thread::id> ids {};
+        for (size_t j {0}; j < 4; ++j) {
+            std::promise<std::thread::id> id {};
+            auto future {id.get_future()};
+            boost::asio::post(pool.at(i), [&id]() {
+                id.set_value(std::this_thread::get_id() );
+            });
+            ids.insert(future.get() );
+        }
+        BOOST_CHECK_EQUAL(ids.size(), 1);
+        threads.push_back(*ids.begin() );
+    }
+    BOOST_CHECK_EQUAL(std::set<std::thread::id>(threads.begin(), threads.end() ).size(), 3);
+    BOOST_CHECK(threads[0] != std::this_thread::get_id() );
+    pool.stop();
+}
+
+BOOST_AUTO_TEST_CASE(stop_with_pending_work, *boost::unit_test::timeout {1})
+{
+    IoContextPool pool {2, false};
+    pool.run();
+    boost::asio::steady_timer timer {pool.next(), std::chrono::hours {1}};
+    timer.async_wait([](auto ec) {});
+
+    // The pending timer does not keep the pool running.
+    pool.stop();
+    BOOST_TEST(true);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_IoContextPool
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
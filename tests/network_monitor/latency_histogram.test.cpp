@@ -0,0 +1,98 @@
+#include <network_monitor/latency_histogram.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::ConnectionLatency;
+using NetworkMonitor::LatencyHistogram;
+
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_LatencyHistogram);
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    LatencyHistogram histogram {};
+    BOOST_CHECK_EQUAL(histogram.count(), 0);
+    BOOST_CHECK(histogram.mean() == 0ns);
+    BOOST_CHECK(histogram.max() == 0ns);
+    BOOST_CHECK(histogram.percentile(0.99) == 0ns);
+}
+
+BOOST_AUTO_TEST_CASE(bucket_bounds)
+{
+    // The buckets are contiguous and grow by at most 25%.
+    BOOST_CHECK(LatencyHistogram::bucketUpperBound(0) == 1us);
+    BOOST_CHECK(LatencyHistogram::bucketUpperBound(3) == 4us);
+    for (size_t i {4}; i < LatencyHistogram::bucketCount; ++i) {
+        const auto lower {LatencyHistogram::bucketUpperBound(i - 1)};
+        const auto upper {LatencyHistogram::bucketUpperBound(i)};
+        BOOST_REQUIRE(upper > lower);
+        BOOST_CHECK(4 * (upper - lower) <= lower);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(percentiles)
+{
+    LatencyHistogram histogram {};
+    for (int i {1}; i <= 100; ++i) {
+        histogram.record(std::chrono::milliseconds {i});
+    }
+    BOOST_CHECK_EQUAL(histogram.count(), 100);
+    BOOST_CHECK(histogram.mean() == 50500us);
+    BOOST_CHECK(histogram.max() == 100ms);
+
+    // Percentiles are bucket upper bounds, at most 25% above the exact value.
+    const auto p50 {histogram.percentile(0.5)};
+    BOOST_CHECK(p50 > 50ms && p50 <= 62500us);
+    const auto p99 {histogram.percentile(0.99)};
+    BOOST_CHECK(p99 > 99ms && p99 <= 100ms);
+    BOOST_CHECK(histogram.percentile(1.0) == 100ms);
+
+    histogram.reset();
+    BOOST_CHECK_EQUAL(histogram.count(), 0);
+    BOOST_CHECK(histogram.max() == 0ns);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_records)
+{
+    LatencyHistogram histogram {};
+    std::vector<std::thread> threads {};
+    for (int t {0}; t < 4; ++t) {
+        threads.emplace_back([&histogram, t]() {
+            for (int i {0}; i < 10000; ++i) {
+                histogram.record(std::chrono::microseconds {t * 1000 + i % 100});
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BOOST_CHECK_EQUAL(histogram.count(), 40000);
+    const auto buckets {histogram.buckets()};
+    BOOST_CHECK_EQUAL(std::accumulate(buckets.begin(), buckets.end(), uint64_t {0}), 40000);
+    BOOST_CHECK(histogram.max() == 3099us);
+}
+
+BOOST_AUTO_TEST_CASE(print)
+{
+    ConnectionLatency latency {};
+    latency.tlsHandshake.record(2ms);
+    std::stringstream ss {};
+    ss << latency;
+    const std::string printed {ss.str()};
+    BOOST_CHECK(printed.find("tls handshake") != std::string::npos);
+    BOOST_CHECK(printed.find("first message") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_LatencyHistogram
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -0,0 +1,96 @@
+#include <network_monitor/logger.hpp>
+
+#include <boost/asio/error.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::ErrorMessage;
+using NetworkMonitor::Logger;
+using NetworkMonitor::LogLevel;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_Logger);
+
+BOOST_AUTO_TEST_CASE(format, *boost::unit_test::timeout {1})
+{
+    std::ostringstream sink {};
+    Logger logger {sink, 16};
+    std::string dynamic {"copied"};
+    logger.log(LogLevel::Error, "literal ", 42, ' ', dynamic, ' ',
+               ErrorMessage {boost::asio::error::connection_refused});
+    // The string was copied when logged.
+    dynamic = "changed";
+    logger.log(LogLevel::Warning, std::string_view {"view"});
+    logger.flush();
+
+    std::istringstream lines {sink.str()};
+    std::string line {};
+    BOOST_REQUIRE(std::getline(lines, line));
+    BOOST_CHECK(line.find(" [error] literal 42 copied Connection refused") != std::string::npos);
+    BOOST_REQUIRE(std::getline(lines, line));
+    BOOST_CHECK(line.find(" [warning] view") != std::string::npos);
+    BOOST_CHECK(!std::getline(lines, line));
+    BOOST_CHECK_EQUAL(logger.dropped(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_producers, *boost::unit_test::timeout {5})
+{
+    std::ostringstream sink {};
+    const int nThreads {4};
+    const int nMessages {1000};
+    {
+        Logger logger {sink, 8192};
+        std::vector<std::thread> threads {};
+        for (int t {0}; t < nThreads; ++t) {
+            threads.emplace_back([&logger, t]() {
+                for (int i {0}; i < nMessages; ++i) {
+                    logger.log(LogLevel::Info, "thread ", t, " message ", i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        BOOST_CHECK_EQUAL(logger.dropped(), 0);
+        // The destructor writes the pending messages.
+    }
+    const std::string out {sink.str()};
+    BOOST_CHECK_EQUAL(std::count(out.begin(), out.end(), '\n'), nThreads * nMessages);
+
+    // Each producer's messages stay in order.
+    BOOST_CHECK(out.find("thread 0 message 998\n") < out.find("thread 0 message 999\n"));
+}
+
+BOOST_AUTO_TEST_CASE(full_ring_drops, *boost::unit_test::timeout {5})
+{
+    std::ostringstream sink {};
+    const int nMessages {100000};
+    Logger logger {sink, 4};
+    for (int i {0}; i < nMessages; ++i) {
+        logger.log(LogLevel::Info, i);
+    }
+    logger.flush();
+
+    // The producer never waits: what does not fit is counted, not written.
+    const std::string out {sink.str()};
+    const auto written {std::count(out.begin(), out.end(), '\n')};
+    BOOST_CHECK_EQUAL(written + logger.dropped(), nMessages);
+}
+
+BOOST_AUTO_TEST_CASE(compile_time_levels)
+{
+    // Debug messages are compiled out by default.
+    BOOST_CHECK(!NetworkMonitor::Detail::isLogged(LogLevel::Debug));
+    BOOST_CHECK(NetworkMonitor::Detail::isLogged(LogLevel::Info));
+    BOOST_CHECK(NetworkMonitor::Detail::isLogged(LogLevel::Error));
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_Logger
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -0,0 +1,272 @@
+#ifndef HPP_TEST_LOOPBACKSERVER_
+#define HPP_TEST_LOOPBACKSERVER_
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace NetworkMonitor {
+
+/*! \brief Make a TLS server context, with a self-signed certificate generated on the fly.
+ *
+ *  The WebSocketClient does not verify the server certificate, so it accepts this one.
+ */
+inline boost::asio::ssl::context makeSelfSignedServerContext() {
+    boost::asio::ssl::context ctx{boost::asio::ssl::context::tls_server};
+
+    const std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key{EVP_EC_gen("P-256"), EVP_PKEY_free};
+    const std::unique_ptr<X509, decltype(&X509_free)> cert{X509_new(), X509_free};
+    if(!key || !cert)
+        throw std::runtime_error("Could not generate the loopback certificate");
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get() ), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get() ), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get() ), 24 * 3600);
+    X509_set_pubkey(cert.get(), key.get() );
+    X509_NAME* name = X509_get_subject_name(cert.get() );
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>("127.0.0.1"), -1, -1, 0);
+    X509_set_issuer_name(cert.get(), name);
+    if(X509_sign(cert.get(), key.get(), EVP_sha256() ) == 0
+       || SSL_CTX_use_certificate(ctx.native_handle(), cert.get() ) != 1
+       || SSL_CTX_use_PrivateKey(ctx.native_handle(), key.get() ) != 1)
+    {
+        throw std::runtime_error("Could not use the loopback certificate");
+    }
+    return ctx;
+}
+
+/*! \brief Bytes sent and received over TCP by the sessions of a LoopbackServer, TLS and
+ *         WebSocket framing included.
+ */
+struct LoopbackTraffic {
+    std::atomic<std::size_t> bytesRead{0};
+    std::atomic<std::size_t> bytesWritten{0};
+};
+
+/*! \brief Rate policy of the session TCP streams, that counts the bytes without limiting them.
+ */
+class ByteCounter {
+public:
+    std::shared_ptr<LoopbackTraffic> traffic{};
+
+private:
+    friend class boost::beast::rate_policy_access;
+
+    std::size_t available_read_bytes() const noexcept {
+        return (std::numeric_limits<std::size_t>::max)();
+    }
+
+    std::size_t available_write_bytes() const noexcept {
+        return (std::numeric_limits<std::size_t>::max)();
+    }
+
+    void transfer_read_bytes(std::size_t n) noexcept {
+        if(traffic)
+            traffic->bytesRead.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void transfer_write_bytes(std::size_t n) noexcept {
+        if(traffic)
+            traffic->bytesWritten.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void on_timer() noexcept {}
+};
+
+/*! \brief A WebSocket connection accepted by the LoopbackServer.
+ *
+ *  Each session runs on its own strand. Like the WebSocketClient, it queues the messages it
+ *  sends and writes them one at a time.
+ */
+class LoopbackSession: public std::enable_shared_from_this<LoopbackSession> {
+public:
+    using MessageHandler = std::function<void(LoopbackSession&, std::string&&)>;
+
+    LoopbackSession(
+        boost::asio::ip::tcp::socket&& socket,
+        boost::asio::ssl::context& ctx,
+        MessageHandler onMessage,
+        std::shared_ptr<LoopbackTraffic> traffic,
+        const boost::beast::websocket::permessage_deflate& deflate
+    ) :
+        m_ws{std::move(socket), ctx},
+        m_onMessage{std::move(onMessage)}
+    {
+        boost::beast::get_lowest_layer(m_ws).rate_policy().traffic = std::move(traffic);
+        m_ws.set_option(deflate);
+    }
+
+    /*! \brief Run the TLS and WebSocket handshakes, then read messages until the client leaves.
+     */
+    void start() {
+        m_ws.next_layer().async_handshake(boost::asio::ssl::stream_base::server,
+            [self = shared_from_this()](auto ec) {
+                if(ec)
+                    return log("TLS handshake", ec);
+                self->m_ws.async_accept([self](auto ec) {
+                    if(ec)
+                        return log("WebSocket accept", ec);
+                    self->m_ws.text(true);
+                    self->read();
+                });
+            }
+        );
+    }
+
+    /*! \brief Queue a message for the client. Can be called from any thread.
+     */
+    void send(std::string message) {
+        boost::asio::dispatch(m_ws.get_executor(),
+            [self = shared_from_this(), message = std::move(message)]() mutable {
+                self->m_writeQueue.push_back(std::move(message) );
+                if(self->m_writeQueue.size() == 1)
+                    self->writeNext();
+            }
+        );
+    }
+
+    /*! \brief The strand of the session. Handlers that use pending() or closed() run on it.
+     */
+    boost::asio::any_io_executor getExecutor() {
+        return m_ws.get_executor();
+    }
+
+    /*! \brief The number of messages queued and not written yet.
+     */
+    std::size_t pending() const {
+        return m_writeQueue.size();
+    }
+
+    /*! \brief Whether the client left, or a read or write failed.
+     */
+    bool closed() const {
+        return m_closed;
+    }
+
+private:
+    using TcpStream = boost::beast::basic_stream<
+        boost::asio::ip::tcp, boost::asio::any_io_executor, ByteCounter
+    >;
+
+    boost::beast::websocket::stream<boost::beast::ssl_stream<TcpStream> > m_ws;
+    boost::beast::flat_buffer m_buffer{};
+    // The front message is the one being written.
+    std::deque<std::string> m_writeQueue{};
+    MessageHandler m_onMessage{};
+    bool m_closed{false};
+
+    static void log(const char* where, boost::system::error_code ec) {
+        if(ec != boost::beast::websocket::error::closed && ec != boost::asio::error::operation_aborted)
+            std::cerr << "[loopback server] " << where << ": " << ec.message() << std::endl;
+    }
+
+    void read() {
+        m_ws.async_read(m_buffer, [self = shared_from_this()](auto ec, auto nBytes) {
+            if(ec) {
+                self->m_closed = true;
+                return log("read", ec);
+            }
+            std::string message{boost::beast::buffers_to_string(self->m_buffer.data() )};
+            self->m_buffer.consume(nBytes);
+            self->m_onMessage(*self, std::move(message) );
+            self->read();
+        });
+    }
+
+    void writeNext() {
+        m_ws.async_write(boost::asio::buffer(m_writeQueue.front() ),
+            [self = shared_from_this()](auto ec, auto) {
+                if(ec) {
+                    self->m_closed = true;
+                    return log("write", ec);
+                }
+                self->m_writeQueue.pop_front();
+                if(!self->m_writeQueue.empty() )
+                    self->writeNext();
+            }
+        );
+    }
+};
+
+/*! \brief Secure WebSocket server on the loopback interface, to test and benchmark
+ *         clients without a network.
+ *
+ *  It listens on an ephemeral port of 127.0.0.1, and hands every message it receives to the
+ *  message handler along with the session it came from.
+ */
+class LoopbackServer {
+public:
+    /*! \brief Start accepting connections.
+     *
+     *  \param deflate The permessage-deflate options of the sessions. Compression is disabled by
+     *                 default; set server_enable to accept it when a client offers it.
+     */
+    LoopbackServer(
+        boost::asio::io_context& ioc,
+        LoopbackSession::MessageHandler onMessage,
+        const boost::beast::websocket::permessage_deflate& deflate = {}
+    ) :
+        m_ioc{ioc},
+        m_ctx{makeSelfSignedServerContext()},
+        m_acceptor{ioc, {boost::asio::ip::make_address("127.0.0.1"), 0}},
+        m_onMessage{std::move(onMessage)},
+        m_deflate{deflate}
+    {
+        accept();
+    }
+
+    /*! \brief The port the server listens on.
+     */
+    unsigned short port() const {
+        return m_acceptor.local_endpoint().port();
+    }
+
+    /*! \brief The bytes exchanged over TCP by all the sessions so far. Thread-safe.
+     */
+    const LoopbackTraffic& traffic() const {
+        return *m_traffic;
+    }
+
+private:
+    boost::asio::io_context& m_ioc;
+    boost::asio::ssl::context m_ctx;
+    boost::asio::ip::tcp::acceptor m_acceptor;
+    LoopbackSession::MessageHandler m_onMessage{};
+    boost::beast::websocket::permessage_deflate m_deflate{};
+    std::shared_ptr<LoopbackTraffic> m_traffic{std::make_shared<LoopbackTraffic>()};
+
+    void accept() {
+        m_acceptor.async_accept(boost::asio::make_strand(m_ioc), [this](auto ec, auto socket) {
+            if(ec) {
+                std::cerr << "[loopback server] accept: " << ec.message() << std::endl;
+                return;
+            }
+            socket.set_option(boost::asio::ip::tcp::no_delay{true});
+            std::make_shared<LoopbackSession>(
+                std::move(socket), m_ctx, m_onMessage, m_traffic, m_deflate
+            )->start();
+            accept();
+        });
+    }
+};
+
+} // namespace NetworkMonitor
+
+#endif // HPP_TEST_LOOPBACKSERVER_
@@ -0,0 +1,238 @@
+#ifndef HPP_TEST_LOOPBACKSTOMPBROKER_
+#define HPP_TEST_LOOPBACKSTOMPBROKER_
+
+#include "loopback_server.hpp"
+
+#include <network_monitor/stomp_frame.hpp>
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief How a LoopbackStompBroker publishes to each subscription.
+ */
+struct LoopbackFeed {
+    //! The bodies of the MESSAGE frames, sent in a loop.
+    std::vector<std::string> bodies{};
+
+    //! Messages per second. Zero sends as fast as the connection takes them.
+    double rate{0};
+
+    //! Messages sent to each subscription, after which the broker stops publishing to it.
+    std::size_t count{0};
+
+    //! Unwritten messages above which the broker waits, so an unpaced feed does not queue
+    //! the whole count in memory.
+    std::size_t maxPending{1024};
+};
+
+/*! \brief The time a LoopbackStompBroker sent a MESSAGE frame, from its message-id header.
+ *
+ *  \returns The epoch of std::chrono::steady_clock if the header was not set by the broker.
+ */
+inline std::chrono::steady_clock::time_point sentAt(const StompFrame& message) {
+    const auto id = message.getHeader(StompHeader::MessageId);
+    std::int64_t ns = 0;
+    std::from_chars(id.data(), id.data() + id.size(), ns);
+    return std::chrono::steady_clock::time_point{std::chrono::nanoseconds{ns}};
+}
+
+/*! \brief STOMP broker on a LoopbackServer, that publishes a feed to every subscription.
+ *
+ *  It speaks the subset of STOMP v1.2 the StompClient uses: it answers STOMP with CONNECTED,
+ *  without heart-beats or authentication, confirms SUBSCRIBE and DISCONNECT with a RECEIPT
+ *  when asked, and replies ERROR to any other frame. It does not check the order of the frames.
+ *
+ *  After a subscription is confirmed, the broker sends it the feed, one MESSAGE frame per
+ *  WebSocket message. The message-id header starts with the steady_clock time the frame was
+ *  queued, in nanoseconds, which sentAt() reads back: since the client runs in the same process,
+ *  it gives the end-to-end latency of each message, including the time queued by the broker.
+ */
+class LoopbackStompBroker {
+public:
+    /*! \brief Start accepting connections.
+     */
+    LoopbackStompBroker(boost::asio::io_context& ioc, LoopbackFeed feed) :
+        m_feed{std::make_shared<const LoopbackFeed>(std::move(feed) )},
+        m_server{ioc, [feed = m_feed](LoopbackSession& session, std::string&& message) {
+            onFrame(feed, session, std::move(message) );
+        }}
+    {
+        if(m_feed->bodies.empty() )
+            throw std::invalid_argument("The loopback feed has no message");
+    }
+
+    /*! \brief The port the broker listens on.
+     */
+    unsigned short port() const {
+        return m_server.port();
+    }
+
+    /*! \brief The bytes exchanged over TCP by all the sessions so far. Thread-safe.
+     */
+    const LoopbackTraffic& traffic() const {
+        return m_server.traffic();
+    }
+
+private:
+    // Sends the feed to one subscription, on the strand of its session.
+    struct Publisher: public std::enable_shared_from_this<Publisher> {
+        std::shared_ptr<LoopbackSession> session;
+        std::shared_ptr<const LoopbackFeed> feed;
+        std::string subscription;
+        std::string destination;
+        boost::asio::steady_timer timer;
+        std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+        std::size_t sent{0};
+
+        Publisher(std::shared_ptr<LoopbackSession> session, std::shared_ptr<const LoopbackFeed> feed,
+                  std::string subscription, std::string destination) :
+            session{std::move(session)},
+            feed{std::move(feed)},
+            subscription{std::move(subscription)},
+            destination{std::move(destination)},
+            timer{this->session->getExecutor()}
+        {
+        }
+
+        // Send the messages due by now, then wait for the next one or for the queue to drain.
+        void publish() {
+            using std::chrono::steady_clock;
+            if(session->closed() )
+                return;
+            const auto now = steady_clock::now();
+            std::size_t due = feed->count;
+            if(feed->rate > 0) {
+                const std::chrono::duration<double> elapsed = now - start;
+                due = std::min(due, static_cast<std::size_t>(elapsed.count() * feed->rate) + 1);
+            }
+            while(sent < due && session->pending() < feed->maxPending) {
+                session->send(makeMessage(steady_clock::now() ) );
+                ++sent;
+            }
+            if(sent == feed->count)
+                return;
+
+            auto next = now;
+            if(session->pending() >= feed->maxPending)
+                next = now + std::chrono::microseconds{100};
+            else if(feed->rate > 0)
+                next = start + std::chrono::duration_cast<steady_clock::duration>(
+                    std::chrono::duration<double>(sent / feed->rate) );
+            timer.expires_at(next);
+            timer.async_wait([self = shared_from_this()](auto ec) {
+                if(!ec)
+                    self->publish();
+            });
+        }
+
+        std::string makeMessage(std::chrono::steady_clock::time_point now) const {
+            const std::string& body = feed->bodies[sent % feed->bodies.size()];
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch() );
+            return makeFrame(StompCommand::Message, {
+                {StompHeader::Subscription, subscription},
+                {StompHeader::MessageId, std::to_string(ns.count() ) + "-" + std::to_string(sent)},
+                {StompHeader::Destination, destination},
+                {StompHeader::ContentLength, std::to_string(body.size() )},
+                {StompHeader::ContentType, "application/json"},
+            }, body);
+        }
+    };
+
+    std::shared_ptr<const LoopbackFeed> m_feed;
+    LoopbackServer m_server;
+
+    static std::string makeFrame(
+        StompCommand command,
+        std::unordered_map<StompHeader, std::string>&& headers,
+        const std::string& body = {}
+    )
+    {
+        StompError error;
+        const StompFrame frame{error, command, std::move(headers), body};
+        if(error != StompError::Ok)
+            throw std::logic_error("Invalid loopback broker frame");
+        return frame.toString();
+    }
+
+    static void onFrame(
+        const std::shared_ptr<const LoopbackFeed>& feed,
+        LoopbackSession& session,
+        std::string&& message
+    )
+    {
+        // The client sends heart-beats as bare EOLs.
+        if(message.find_first_not_of("\r\n") == std::string::npos)
+            return;
+        StompError error;
+        const StompFrame frame{error, std::move(message)};
+        if(error != StompError::Ok) {
+            std::cerr << "[loopback broker] invalid frame: " << error << std::endl;
+            session.send(makeError("Invalid frame") );
+            return;
+        }
+        switch(frame.getCommand() ) {
+        case StompCommand::Stomp:
+            session.send(makeFrame(StompCommand::Connected, {
+                {StompHeader::Version, "1.2"},
+                {StompHeader::Session, "loopback"},
+                {StompHeader::HeartBeat, "0,0"},
+            }) );
+        break;
+        case StompCommand::Subscribe: {
+            if(!frame.hasHeader(StompHeader::Destination) || !frame.hasHeader(StompHeader::Id) ) {
+                session.send(makeError("SUBSCRIBE needs a destination and an id") );
+                return;
+            }
+            sendReceipt(session, frame);
+            const auto publisher = std::make_shared<Publisher>(
+                session.shared_from_this(),
+                feed,
+                std::string(frame.getHeader(StompHeader::Id) ),
+                std::string(frame.getHeader(StompHeader::Destination) )
+            );
+            publisher->publish();
+        }
+        break;
+        case StompCommand::Disconnect:
+            sendReceipt(session, frame);
+        break;
+        default:
+            session.send(makeError("Unsupported frame") );
+        break;
+        }
+    }
+
+    static void sendReceipt(LoopbackSession& session, const StompFrame& frame) {
+        if(frame.hasHeader(StompHeader::Receipt) ) {
+            session.send(makeFrame(StompCommand::Receipt, {
+                {StompHeader::ReceiptId, std::string(frame.getHeader(StompHeader::Receipt) )},
+            }) );
+        }
+    }
+
+    static std::string makeError(const std::string& reason) {
+        return makeFrame(StompCommand::Error, {
+            {StompHeader::ContentLength, std::to_string(reason.size() )},
+            {StompHeader::ContentType, "text/plain"},
+        }, reason);
+    }
+};
+
+} // namespace NetworkMonitor
+
+#endif // HPP_TEST_LOOPBACKSTOMPBROKER_
@@ -1,4 +1,5 @@
 
+#include "loopback_stomp_broker.hpp"
 #include "websocketclient_mock.hpp"
 
 #include <network_monitor/stomp_client.hpp>
@@ -10,14 +11,17 @@
 
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 using NetworkMonitor::BoostWebSocketClient;
+using NetworkMonitor::LoopbackStompBroker;
 using NetworkMonitor::MockWebSocketClientForStomp;
 using NetworkMonitor::StompClient;
 using NetworkMonitor::StompClientError;
 using NetworkMonitor::StompCommand;
 using NetworkMonitor::StompError;
 using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompHeader;
 
 using namespace std::string_literals;
 
@@ -38,6 +42,8 @@ struct StompClientTestFixture {
         MockWebSocketClientForStomp::s_triggerDisconnection = false;
         MockWebSocketClientForStomp::s_messageQueue = {};
         MockWebSocketClientForStomp::s_subscriptionMessages = {};
+        MockWebSocketClientForStomp::s_heartBeat = {};
+        MockWebSocketClientForStomp::s_heartBeatsReceived = 0;
     }
 };
 
@@ -282,6 +288,86 @@ BOOST_AUTO_TEST_CASE(close_before_connect, *timeout {1})
     BOOST_TEST(closed);
 }
 
+BOOST_AUTO_TEST_CASE(heart_beat_send, *timeout {1})
+{
+    // Since we use the mock, we do not actually connect to this remote.
+    const std::string url {"ltnm.learncppthroughprojects.com"};
+    const std::string endpoint {"/network-events"};
+    const std::string port {"443"};
+    const std::string username {"some_username"};
+    const std::string password {"some_password_123"};
+    boost::asio::io_context ioc {};
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+
+    // The server wants a heart-beat every 20ms, and does not send any.
+    MockWebSocketClientForStomp::s_heartBeat = "0,20";
+
+    StompClient<MockWebSocketClientForStomp> client {
+        url,
+        endpoint,
+        port,
+        ioc,
+        ctx
+    };
+    client.setHeartBeat(std::chrono::milliseconds {10}, std::chrono::milliseconds {10});
+    boost::asio::steady_timer timer {ioc};
+    auto onConnect {[&client, &timer](auto ec) {
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        timer.expires_after(std::chrono::milliseconds {150});
+        timer.async_wait([&client](auto ec) {
+            client.close();
+        });
+    }};
+    client.connect(username, password, onConnect);
+    ioc.run();
+    // The negotiated interval is 20ms.
+    BOOST_TEST(MockWebSocketClientForStomp::s_heartBeatsReceived >= 3);
+    BOOST_TEST(MockWebSocketClientForStomp::s_heartBeatsReceived <= 8);
+}
+
+BOOST_AUTO_TEST_CASE(heart_beat_timeout, *timeout {1})
+{
+    // Since we use the mock, we do not actually connect to this remote.
+    const std::string url {"ltnm.learncppthroughprojects.com"};
+    const std::string endpoint {"/network-events"};
+    const std::string port {"443"};
+    const std::string username {"some_username"};
+    const std::string password {"some_password_123"};
+    boost::asio::io_context ioc {};
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+
+    // The server promises a heart-beat every 20ms, but stays silent.
+    MockWebSocketClientForStomp::s_heartBeat = "20,0";
+
+    StompClient<MockWebSocketClientForStomp> client {
+        url,
+        endpoint,
+        port,
+        ioc,
+        ctx
+    };
+    client.setHeartBeat(std::chrono::milliseconds {0}, std::chrono::milliseconds {10});
+    bool connected {false};
+    bool timedOut {false};
+    auto onConnect {[&connected](auto ec) {
+        connected = true;
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+    }};
+    auto onDisconnect {[&timedOut](auto ec) {
+        timedOut = true;
+        BOOST_CHECK_EQUAL(ec, StompClientError::HeartBeatTimeout);
+    }};
+    client.connect(username, password, onConnect, onDisconnect);
+    // The client closes the silent connection itself, otherwise the mock keeps it open and
+    // ioc.run() does not return.
+    ioc.run();
+    BOOST_TEST(connected);
+    BOOST_TEST(timedOut);
+    BOOST_CHECK_EQUAL(MockWebSocketClientForStomp::s_heartBeatsReceived, 0);
+}
+
 BOOST_AUTO_TEST_CASE(subscribe, *timeout {1})
 {
     // Since we use the mock, we do not actually connect to this remote.
@@ -435,6 +521,263 @@ BOOST_AUTO_TEST_CASE(subscribe_get_message, *timeout {1})
     BOOST_TEST(messageReceived);
 }
 
+BOOST_AUTO_TEST_CASE(subscribe_get_frame, *timeout {1})
+{
+    // Since we use the mock, we do not actually connect to this remote.
+    const std::string url {"ltnm.learncppthroughprojects.com"};
+    const std::string endpoint {"/network-events"};
+    const std::string port {"443"};
+    const std::string username {"some_username"};
+    const std::string password {"some_password_123"};
+    boost::asio::io_context ioc {};
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+
+    // Setup the mock.
+    MockWebSocketClientForStomp::s_subscriptionMessages = {
+        "{counter: 1}",
+    };
+
+    StompClient<MockWebSocketClientForStomp> client {
+        url,
+        endpoint,
+        port,
+        ioc,
+        ctx
+    };
+    bool messageReceived {false};
+    auto onMessage {[&messageReceived, &client](auto ec, const StompFrame& frame) {
+        messageReceived = true;
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        BOOST_CHECK_EQUAL(frame.getCommand(), StompCommand::Message);
+        BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::Destination), "/passengers");
+        BOOST_CHECK_EQUAL(frame.getBody(), "{counter: 1}");
+        client.close([](auto ec) {});
+    }};
+    auto onConnect {[&client, &onMessage](auto ec) {
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        client.subscribeFrames("/passengers", nullptr, onMessage);
+    }};
+    client.connect(username, password, onConnect);
+    ioc.run();
+    BOOST_TEST(messageReceived);
+}
+
+BOOST_AUTO_TEST_CASE(subscribe_twice, *timeout {1})
+{
+    // Since we use the mock, we do not actually connect to this remote.
+    const std::string url {"ltnm.learncppthroughprojects.com"};
+    const std::string endpoint {"/network-events"};
+    const std::string port {"443"};
+    const std::string username {"some_username"};
+    const std::string password {"some_password_123"};
+    boost::asio::io_context ioc {};
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+
+    // Setup the mock.
+    MockWebSocketClientForStomp::s_subscriptionMessages = {
+        "{counter: 1}",
+        "{counter: 2}",
+    };
+
+    StompClient<MockWebSocketClientForStomp> client {
+        url,
+        endpoint,
+        port,
+        ioc,
+        ctx
+    };
+    // Each subscription gets its own receipt and its own messages.
+    std::vector<std::string> subscribed {};
+    std::vector<std::string> firstMessages {};
+    std::vector<std::string> secondMessages {};
+    auto onSubscribe {[&subscribed](auto ec, auto&& id) {
+        BOOST_CHECK_EQUAL(ec, StompClientError::Ok);
+        subscribed.push_back(id);
+    }};
+    auto closeWhenDone {[&]() {
+        if (firstMessages.size() == 2 && secondMessages.size() == 2) {
+            client.close([](auto ec) {});
+        }
+    }};
+    auto onFirstMessage {[&](auto ec, auto&& msg) {
+        BOOST_CHECK_EQUAL(ec, StompClientError::Ok);
+        firstMessages.push_back(msg);
+        closeWhenDone();
+    }};
+    auto onSecondMessage {[&](auto ec, auto&& msg) {
+        BOOST_CHECK_EQUAL(ec, StompClientError::Ok);
+        secondMessages.push_back(msg);
+        closeWhenDone();
+    }};
+    std::string firstId {};
+    std::string secondId {};
+    auto onConnect {[&](auto ec) {
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        firstId = client.subscribe("/passengers", onSubscribe, onFirstMessage);
+        secondId = client.subscribe("/passengers", onSubscribe, onSecondMessage);
+        BOOST_REQUIRE(firstId != secondId);
+    }};
+    client.connect(username, password, onConnect);
+    ioc.run();
+    BOOST_CHECK((subscribed == std::vector<std::string> {firstId, secondId}));
+    BOOST_REQUIRE_EQUAL(firstMessages.size(), 2);
+    BOOST_REQUIRE_EQUAL(secondMessages.size(), 2);
+    BOOST_TEST(firstMessages[0].find("subscription:" + firstId + "\n") != std::string::npos);
+    BOOST_TEST(secondMessages[1].find("subscription:" + secondId + "\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(reconnect_and_resubscribe, *timeout {1})
+{
+    // Since we use the mock, we do not actually connect to this remote.
+    const std::string url {"ltnm.learncppthroughprojects.com"};
+    const std::string endpoint {"/network-events"};
+    const std::string port {"443"};
+    const std::string username {"some_username"};
+    const std::string password {"some_password_123"};
+    boost::asio::io_context ioc {};
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+
+    MockWebSocketClientForStomp::s_subscriptionMessages = {
+        "{counter: 1}",
+    };
+
+    StompClient<MockWebSocketClientForStomp> client {
+        url,
+        endpoint,
+        port,
+        ioc,
+        ctx
+    };
+    client.setReconnect(std::chrono::milliseconds {5}, std::chrono::milliseconds {20});
+    size_t nConnects {0};
+    size_t nSubscribes {0};
+    size_t nMessages {0};
+    std::string subscriptionId {};
+    auto onSubscribe {[&nSubscribes](auto ec, auto&& id) {
+        ++nSubscribes;
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+    }};
+    auto onMessage {[&client, &nMessages, &subscriptionId](auto ec, const auto& frame) {
+        ++nMessages;
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        // The subscription keeps its ID across the reconnection.
+        BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::Subscription), subscriptionId);
+        if (nMessages == 1) {
+            // The broker drops the connection.
+            MockWebSocketClientForStomp::s_triggerDisconnection = true;
+        } else {
+            client.close();
+        }
+    }};
+    auto onConnect {[&client, &nConnects, &subscriptionId, &onSubscribe, &onMessage](auto ec) {
+        ++nConnects;
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        subscriptionId = client.subscribeFrames("/passengers", onSubscribe, onMessage);
+    }};
+    auto onDisconnect {[](auto ec) {
+        // We should never get here.
+        BOOST_TEST(false);
+    }};
+    client.connect(username, password, onConnect, onDisconnect);
+    ioc.run();
+    BOOST_CHECK_EQUAL(nConnects, 1);
+    BOOST_CHECK_EQUAL(nMessages, 2);
+    // The receipt of the new SUBSCRIBE frame is not reported again.
+    BOOST_CHECK_EQUAL(nSubscribes, 1);
+}
+
+BOOST_AUTO_TEST_CASE(reconnect_after_heart_beat_timeout, *timeout {1})
+{
+    // Since we use the mock, we do not actually connect to this remote.
+    const std::string url {"ltnm.learncppthroughprojects.com"};
+    const std::string endpoint {"/network-events"};
+    const std::string port {"443"};
+    const std::string username {"some_username"};
+    const std::string password {"some_password_123"};
+    boost::asio::io_context ioc {};
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+
+    // The server promises a heart-beat every 20ms, but only sends the message.
+    MockWebSocketClientForStomp::s_heartBeat = "20,0";
+    MockWebSocketClientForStomp::s_subscriptionMessages = {
+        "{counter: 1}",
+    };
+
+    StompClient<MockWebSocketClientForStomp> client {
+        url,
+        endpoint,
+        port,
+        ioc,
+        ctx
+    };
+    client.setHeartBeat(std::chrono::milliseconds {0}, std::chrono::milliseconds {10});
+    client.setReconnect(std::chrono::milliseconds {5}, std::chrono::milliseconds {20});
+    size_t nConnects {0};
+    size_t nMessages {0};
+    auto onMessage {[&client, &nMessages](auto ec, const auto& frame) {
+        ++nMessages;
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        // The second message comes from the subscription issued again on the new connection.
+        if (nMessages == 2) {
+            client.close();
+        }
+    }};
+    auto onConnect {[&client, &nConnects, &onMessage](auto ec) {
+        ++nConnects;
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        client.subscribeFrames("/passengers", nullptr, onMessage);
+    }};
+    auto onDisconnect {[](auto ec) {
+        // We should never get here.
+        BOOST_TEST(false);
+    }};
+    client.connect(username, password, onConnect, onDisconnect);
+    ioc.run();
+    BOOST_CHECK_EQUAL(nConnects, 1);
+    BOOST_CHECK_EQUAL(nMessages, 2);
+}
+
+BOOST_AUTO_TEST_CASE(reconnect_give_up, *timeout {1})
+{
+    // Since we use the mock, we do not actually connect to this remote.
+    const std::string url {"ltnm.learncppthroughprojects.com"};
+    const std::string endpoint {"/network-events"};
+    const std::string port {"443"};
+    const std::string username {"some_username"};
+    const std::string password {"some_password_123"};
+    boost::asio::io_context ioc {};
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+
+    StompClient<MockWebSocketClientForStomp> client {
+        url,
+        endpoint,
+        port,
+        ioc,
+        ctx
+    };
+    client.setReconnect(std::chrono::milliseconds {1}, std::chrono::milliseconds {4}, 3);
+    bool calledOnDisconnect {false};
+    auto onConnect {[](auto ec) {
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        // The broker drops the connection, and refuses the following ones.
+        MockWebSocketClientForStomp::s_triggerDisconnection = true;
+        MockWebSocketClientForStomp::s_connectEc = boost::asio::error::connection_refused;
+    }};
+    auto onDisconnect {[&calledOnDisconnect](auto ec) {
+        calledOnDisconnect = true;
+        // Reported with the error of the last attempt.
+        BOOST_CHECK_EQUAL(ec, StompClientError::CouldNotConnectToWebSocketServer);
+    }};
+    client.connect(username, password, onConnect, onDisconnect);
+    ioc.run();
+    BOOST_TEST(calledOnDisconnect);
+}
+
 BOOST_AUTO_TEST_CASE(subscribe_before_connect, *timeout {1})
 {
     // Since we use the mock, we do not actually connect to this remote.
@@ -548,6 +891,58 @@ BOOST_AUTO_TEST_CASE(subscribe_to_invalid_endpoint, *timeout {1})
     BOOST_TEST(calledOnDisconnect);
 }
 
+BOOST_AUTO_TEST_CASE(loopback, *timeout {3})
+{
+    const std::vector<std::string> events {
+        R"({"datetime":"2020-11-01T07:18:50.234000Z","passenger_event":"in","station_id":"station_0"})",
+        R"({"datetime":"2020-11-01T07:18:51.234000Z","passenger_event":"out","station_id":"station_1"})",
+    };
+    const size_t count {100};
+    boost::asio::io_context ioc {};
+    LoopbackStompBroker broker {ioc, {events, 0, count}};
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+
+    StompClient<BoostWebSocketClient> client {
+        "127.0.0.1",
+        "/",
+        std::to_string(broker.port()),
+        ioc,
+        ctx
+    };
+
+    bool calledOnClose {false};
+    bool calledOnSubscribe {false};
+    std::vector<std::string> bodies {};
+    auto onMessage {[&](auto ec, const StompFrame& frame) {
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::Destination), "/passengers");
+        bodies.emplace_back(frame.getBody());
+        if (bodies.size() == count) {
+            client.close([&calledOnClose, &ioc](auto ec) {
+                calledOnClose = true;
+                BOOST_CHECK_EQUAL(ec, StompClientError::Ok);
+                ioc.stop();
+            });
+        }
+    }};
+    client.connect("some_username", "some_password_123", [&](auto ec) {
+        BOOST_REQUIRE_EQUAL(ec, StompClientError::Ok);
+        client.subscribeFrames("/passengers", [&calledOnSubscribe](auto ec, auto&& id) {
+            calledOnSubscribe = true;
+            BOOST_CHECK_EQUAL(ec, StompClientError::Ok);
+        }, onMessage);
+    });
+
+    ioc.run();
+
+    BOOST_TEST(calledOnSubscribe);
+    BOOST_TEST(calledOnClose);
+    BOOST_REQUIRE_EQUAL(bodies.size(), count);
+    BOOST_CHECK_EQUAL(bodies[0], events[0]);
+    BOOST_CHECK_EQUAL(bodies[1], events[1]);
+    BOOST_CHECK_EQUAL(bodies[2], events[0]);
+}
+
 static std::string GetEnvVar(
     const std::string& envVar,
     const std::string& defaultValue = ""
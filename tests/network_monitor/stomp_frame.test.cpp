@@ -1,6 +1,7 @@
 
 #include <network_monitor/stomp_frame.hpp>
 
+#include <boost/beast/core/buffers_to_string.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include <optional>
@@ -9,6 +10,7 @@
 using NetworkMonitor::StompCommand;
 using NetworkMonitor::StompError;
 using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompFrameWriter;
 using NetworkMonitor::StompHeader;
 
 using namespace std::string_literals;
@@ -141,6 +143,44 @@ BOOST_AUTO_TEST_CASE(parse_bad_command)
     BOOST_CHECK_EQUAL(error, StompError::Parsing);
 }
 
+BOOST_AUTO_TEST_CASE(parse_unknown_command_same_hash)
+{
+    // Same length, first, middle and last characters as MESSAGE: it falls in the same slot of
+    // the command table, and must still be rejected.
+    for(const auto& command : {"MASSAGE"s, "message"s, "MESSAG"s}) {
+        std::string plain {
+            command + "\n"
+            "subscription:<subscription_id>\n"
+            "message-id:<message_id>\n"
+            "destination:/passengers\n"
+            "\n"
+            "Frame body\0"s
+        };
+        StompError error;
+        StompFrame frame {error, std::move(plain)};
+        BOOST_CHECK_EQUAL(error, StompError::Parsing);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parse_unknown_header_same_hash)
+{
+    // Same length, first, middle and last characters as destination.
+    for(const auto& header : {"destinction"s, "DESTINATION"s, "destinatio"s}) {
+        std::string plain {
+            "MESSAGE\n"
+            "subscription:<subscription_id>\n"
+            "message-id:<message_id>\n"
+            "destination:/passengers\n"
+            + header + ":/passengers\n"
+            "\n"
+            "Frame body\0"s
+        };
+        StompError error;
+        StompFrame frame {error, std::move(plain)};
+        BOOST_CHECK_EQUAL(error, StompError::Parsing);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(parse_bad_header)
 {
     std::string plain {
@@ -419,6 +459,124 @@ BOOST_AUTO_TEST_CASE(parse_content_length_exceeding)
     BOOST_CHECK_EQUAL(error, StompError::Validation);
 }
 
+BOOST_AUTO_TEST_CASE(parse_content_length_overflow)
+{
+    std::string plain {
+        "MESSAGE\n"
+        "subscription:<subscription_id>\n"
+        "message-id:<message_id>\n"
+        "destination:/passengers\n"
+        "content-length:99999999999999999999999\n" // Does not fit in size_t
+        "\n"
+        "Frame body\0"s
+    };
+    StompError error;
+    StompFrame frame {error, std::move(plain)};
+    BOOST_TEST(error != StompError::Ok);
+    BOOST_CHECK_EQUAL(error, StompError::Parsing);
+}
+
+BOOST_AUTO_TEST_CASE(parse_content_length_past_frame_end)
+{
+    // The content-length covers the NULL octet and runs past the end of the frame.
+    std::string plain {
+        "MESSAGE\n"
+        "subscription:<subscription_id>\n"
+        "message-id:<message_id>\n"
+        "destination:/passengers\n"
+        "content-length:11\n"
+        "\n"
+        "Frame body\0"s
+    };
+    StompError error;
+    StompFrame frame {error, std::move(plain)};
+    BOOST_TEST(error != StompError::Ok);
+    BOOST_CHECK_EQUAL(error, StompError::Validation);
+}
+
+BOOST_AUTO_TEST_CASE(parse_null_in_body_content_length)
+{
+    std::string plain {
+        "MESSAGE\n"
+        "subscription:<subscription_id>\n"
+        "message-id:<message_id>\n"
+        "destination:/passengers\n"
+        "content-length:10\n"
+        "\n"
+        "Frame\0body\0"s
+    };
+    StompError error;
+    StompFrame frame {error, std::move(plain)};
+    BOOST_TEST_REQUIRE(error == StompError::Ok);
+    BOOST_CHECK_EQUAL(frame.getCommand(), StompCommand::Message);
+    BOOST_CHECK(frame.getBody() == "Frame\0body"s);
+}
+
+BOOST_AUTO_TEST_CASE(parse_null_in_body)
+{
+    // Without a content-length, the first NULL octet ends the body.
+    std::string plain {
+        "MESSAGE\n"
+        "subscription:<subscription_id>\n"
+        "message-id:<message_id>\n"
+        "destination:/passengers\n"
+        "\n"
+        "Frame\0body\0"s
+    };
+    StompError error;
+    StompFrame frame {error, std::move(plain)};
+    BOOST_TEST(error != StompError::Ok);
+    BOOST_CHECK_EQUAL(error, StompError::Parsing);
+}
+
+BOOST_AUTO_TEST_CASE(parse_crlf)
+{
+    std::string plain {
+        "MESSAGE\r\n"
+        "subscription:<subscription_id>\r\n"
+        "message-id:<message_id>\r\n"
+        "destination:/passengers\r\n"
+        "content-length:10\r\n"
+        "\r\n"
+        "Frame body\0\r\n\n\r\n"s
+    };
+    StompError error;
+    StompFrame frame {error, std::move(plain)};
+    BOOST_TEST_REQUIRE(error == StompError::Ok);
+    BOOST_CHECK_EQUAL(frame.getCommand(), StompCommand::Message);
+    BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::Subscription), "<subscription_id>");
+    BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::MessageId), "<message_id>");
+    BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::Destination), "/passengers");
+    BOOST_CHECK_EQUAL(frame.getBody(), "Frame body");
+}
+
+BOOST_AUTO_TEST_CASE(parse_carriage_return_without_newline)
+{
+    // A CR alone is not an EOL, in a header line or after the body.
+    std::string inHeader {
+        "MESSAGE\n"
+        "subscription:<subscription_id>\r"
+        "message-id:<message_id>\n"
+        "destination:/passengers\n"
+        "\n"
+        "Frame body\0"s
+    };
+    StompError error;
+    StompFrame frame {error, std::move(inHeader)};
+    BOOST_CHECK_EQUAL(error, StompError::Parsing);
+
+    std::string afterBody {
+        "MESSAGE\n"
+        "subscription:<subscription_id>\n"
+        "message-id:<message_id>\n"
+        "destination:/passengers\n"
+        "\n"
+        "Frame body\0\r"s
+    };
+    StompFrame frame2 {error, std::move(afterBody)};
+    BOOST_CHECK_EQUAL(error, StompError::Parsing);
+}
+
 BOOST_AUTO_TEST_CASE(parse_required_headers)
 {
     StompError error;
@@ -481,6 +639,46 @@ BOOST_AUTO_TEST_CASE(copy_constructors)
     BOOST_CHECK_EQUAL(assigned->getBody(), "Frame body");
 }
 
+BOOST_AUTO_TEST_CASE(parse_escaped_header)
+{
+    std::string plain {
+        "MESSAGE\n"
+        "subscription:<subscription_id>\n"
+        "message-id:a\\cb\\nc\\\\d\n"
+        "destination:/passengers\n"
+        "\n"
+        "Frame body\0"s
+    };
+    StompError error;
+    StompFrame frame {error, std::move(plain)};
+    BOOST_TEST_REQUIRE(error == StompError::Ok);
+    BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::MessageId), "a:b\nc\\d");
+    BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::Subscription), "<subscription_id>");
+
+    // Views stay valid across copies of a frame with decoded headers.
+    std::optional<StompFrame> copied;
+    {
+        const StompFrame source {frame};
+        copied = source;
+    }
+    BOOST_CHECK_EQUAL(copied->getHeader(StompHeader::MessageId), "a:b\nc\\d");
+}
+
+BOOST_AUTO_TEST_CASE(parse_bad_escape)
+{
+    std::string plain {
+        "MESSAGE\n"
+        "subscription:<subscription_id>\n"
+        "message-id:<message\\t_id>\n"
+        "destination:/passengers\n"
+        "\n"
+        "Frame body\0"s
+    };
+    StompError error;
+    StompFrame frame {error, std::move(plain)};
+    BOOST_CHECK_EQUAL(error, StompError::Parsing);
+}
+
 BOOST_AUTO_TEST_CASE(constructor_from_components_full)
 {
     StompError error;
@@ -530,6 +728,26 @@ BOOST_AUTO_TEST_CASE(constructor_from_components_empty_body)
     BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::Host), "host.com");
 }
 
+BOOST_AUTO_TEST_CASE(constructor_from_components_escaped)
+{
+    StompError error;
+    const StompFrame frame {
+        error,
+        StompCommand::Send,
+        {
+            {StompHeader::Destination, "/passengers:\nnext\\"},
+        },
+        "Frame body"
+    };
+    BOOST_TEST_REQUIRE(error == StompError::Ok);
+    BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::Destination), "/passengers:\nnext\\");
+
+    StompFrame parsed {error, frame.toString()};
+    BOOST_TEST_REQUIRE(error == StompError::Ok);
+    BOOST_CHECK_EQUAL(parsed.getHeader(StompHeader::Destination), "/passengers:\nnext\\");
+    BOOST_CHECK_EQUAL(parsed.getBody(), "Frame body");
+}
+
 BOOST_AUTO_TEST_CASE(to_string)
 {
     const std::string plain {
@@ -547,6 +765,86 @@ BOOST_AUTO_TEST_CASE(to_string)
 }
 
 
+BOOST_AUTO_TEST_SUITE(class_StompFrameWriter);
+
+BOOST_AUTO_TEST_CASE(write_string)
+{
+    std::string out {"previous"};
+    const auto error = StompFrameWriter::write(
+        out,
+        StompCommand::Send,
+        {
+            {StompHeader::Destination, "/passengers:\nnext\\"},
+            {StompHeader::ContentType, "application/json"},
+        },
+        "Frame body"
+    );
+    BOOST_TEST_REQUIRE(error == StompError::Ok);
+    BOOST_CHECK_EQUAL(out.size(), 8 + StompFrameWriter::frameSize(
+        StompCommand::Send,
+        {
+            {StompHeader::Destination, "/passengers:\nnext\\"},
+            {StompHeader::ContentType, "application/json"},
+        },
+        "Frame body"
+    ) );
+
+    // The frame is appended to the buffer.
+    BOOST_CHECK_EQUAL(out.substr(0, 8), "previous");
+    StompError parseError;
+    StompFrame frame {parseError, out.substr(8)};
+    BOOST_TEST_REQUIRE(parseError == StompError::Ok);
+    BOOST_TEST(frame.getCommand() == StompCommand::Send);
+    BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::Destination), "/passengers:\nnext\\");
+    BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::ContentType), "application/json");
+    BOOST_CHECK_EQUAL(frame.getBody(), "Frame body");
+}
+
+BOOST_AUTO_TEST_CASE(write_long_escaped_value)
+{
+    // Long enough for the value to be escaped in several 16 byte blocks.
+    std::string value {};
+    for(size_t i=0; i<100; ++i)
+        value += (i % 7 == 0) ? ":" : (i % 11 == 0) ? "\n" : "x";
+    std::string out {};
+    BOOST_TEST_REQUIRE(StompFrameWriter::write(out, StompCommand::Send, {{StompHeader::Destination, value}}) == StompError::Ok);
+    StompError error;
+    StompFrame frame {error, std::move(out)};
+    BOOST_TEST_REQUIRE(error == StompError::Ok);
+    BOOST_CHECK_EQUAL(frame.getHeader(StompHeader::Destination), value);
+}
+
+BOOST_AUTO_TEST_CASE(write_flat_buffer)
+{
+    boost::beast::flat_buffer out {};
+    BOOST_TEST_REQUIRE(StompFrameWriter::write(out, StompCommand::Disconnect) == StompError::Ok);
+    BOOST_TEST_REQUIRE(StompFrameWriter::write(
+        out,
+        StompCommand::Subscribe,
+        {
+            {StompHeader::Destination, "/passengers"},
+            {StompHeader::Id, "1"},
+        }
+    ) == StompError::Ok);
+    BOOST_CHECK_EQUAL(boost::beast::buffers_to_string(out.data() ),
+        "DISCONNECT\n\n\0"
+        "SUBSCRIBE\ndestination:/passengers\nid:1\n\n\0"s
+    );
+}
+
+BOOST_AUTO_TEST_CASE(write_invalid_frame)
+{
+    std::string out {"previous"};
+    BOOST_CHECK_EQUAL(StompFrameWriter::write(out, StompCommand::Subscribe, {{StompHeader::Id, "1"}}),
+                      StompError::Validation);
+    BOOST_CHECK_EQUAL(StompFrameWriter::write(out, StompCommand::Disconnect, {}, "Frame body"),
+                      StompError::Validation);
+    BOOST_CHECK_EQUAL(out, "previous");
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StompFrameWriter
+
+
 BOOST_AUTO_TEST_SUITE_END(); // stomp_frame
 
 
@@ -0,0 +1,167 @@
+#include <network_monitor/stomp_stream_parser.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using NetworkMonitor::StompCommand;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompHeader;
+using NetworkMonitor::StompStreamParser;
+
+using namespace std::string_literals;
+
+namespace {
+
+struct ParsedFrames {
+    std::vector<StompError> errors{};
+    std::vector<StompFrame> frames{};
+
+    StompStreamParser makeParser(size_t maxFrameSize = StompStreamParser::defaultMaxFrameSize) {
+        return StompStreamParser{
+            [this](StompError ec, StompFrame&& frame) {
+                errors.push_back(ec);
+                frames.push_back(std::move(frame) );
+            },
+            maxFrameSize
+        };
+    }
+};
+
+const std::string messageFrame {
+    "MESSAGE\n"
+    "subscription:<subscription_id>\n"
+    "message-id:<message_id>\n"
+    "destination:/passengers\n"
+    "\n"
+    "Frame body\0"s
+};
+
+const std::string receiptFrame {
+    "RECEIPT\r\n"
+    "receipt-id:42\r\n"
+    "\r\n"
+    "\0"s
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+
+BOOST_AUTO_TEST_SUITE(stomp_stream_parser);
+
+
+BOOST_AUTO_TEST_SUITE(class_StompStreamParser);
+
+
+BOOST_AUTO_TEST_CASE(single_frame)
+{
+    ParsedFrames parsed{};
+    auto parser = parsed.makeParser();
+    BOOST_CHECK_EQUAL(parser.push(std::string(messageFrame) ), StompError::Ok);
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 1);
+    BOOST_CHECK_EQUAL(parsed.errors[0], StompError::Ok);
+    BOOST_CHECK_EQUAL(parsed.frames[0].getCommand(), StompCommand::Message);
+    BOOST_CHECK_EQUAL(parsed.frames[0].getHeader(StompHeader::Destination), "/passengers");
+    BOOST_CHECK_EQUAL(parsed.frames[0].getBody(), "Frame body");
+    BOOST_CHECK_EQUAL(parser.bufferedSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(split_frames)
+{
+    // Feed the stream one byte at a time.
+    const std::string stream = messageFrame + receiptFrame;
+    ParsedFrames parsed{};
+    auto parser = parsed.makeParser();
+    for(size_t i=0; i<stream.size(); ++i) {
+        BOOST_CHECK_EQUAL(parser.push(std::string_view(stream).substr(i, 1) ), StompError::Ok);
+        BOOST_CHECK_EQUAL(parsed.frames.size(), (i + 1 >= messageFrame.size() ) + (i + 1 == stream.size() ) );
+    }
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 2);
+    BOOST_CHECK_EQUAL(parsed.errors[0], StompError::Ok);
+    BOOST_CHECK_EQUAL(parsed.errors[1], StompError::Ok);
+    BOOST_CHECK_EQUAL(parsed.frames[0].getBody(), "Frame body");
+    BOOST_CHECK_EQUAL(parsed.frames[1].getCommand(), StompCommand::Receipt);
+    BOOST_CHECK_EQUAL(parsed.frames[1].getHeader(StompHeader::ReceiptId), "42");
+    BOOST_CHECK_EQUAL(parser.bufferedSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(concatenated_frames_and_heartbeats)
+{
+    const std::string stream = "\n\r\n"s + messageFrame + "\n" + receiptFrame + messageFrame + "\n\n";
+    ParsedFrames parsed{};
+    auto parser = parsed.makeParser();
+    BOOST_CHECK_EQUAL(parser.push(stream), StompError::Ok);
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 3);
+    BOOST_CHECK_EQUAL(parsed.frames[0].getCommand(), StompCommand::Message);
+    BOOST_CHECK_EQUAL(parsed.frames[1].getCommand(), StompCommand::Receipt);
+    BOOST_CHECK_EQUAL(parsed.frames[2].getCommand(), StompCommand::Message);
+    for(const auto error : parsed.errors)
+        BOOST_CHECK_EQUAL(error, StompError::Ok);
+    BOOST_CHECK_EQUAL(parser.bufferedSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(content_length_body_with_null)
+{
+    const std::string frame {
+        "MESSAGE\n"
+        "subscription:<subscription_id>\n"
+        "message-id:<message_id>\n"
+        "destination:/passengers\n"
+        "content-length:11\n"
+        "\n"
+        "Frame\0 body\0"s
+    };
+    const std::string stream = frame + frame;
+    ParsedFrames parsed{};
+    auto parser = parsed.makeParser();
+    BOOST_CHECK_EQUAL(parser.push(std::string_view(stream).substr(0, 100) ), StompError::Ok);
+    BOOST_CHECK_EQUAL(parser.push(std::string_view(stream).substr(100) ), StompError::Ok);
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 2);
+    BOOST_CHECK_EQUAL(parsed.errors[0], StompError::Ok);
+    BOOST_CHECK_EQUAL(parsed.errors[1], StompError::Ok);
+    BOOST_CHECK_EQUAL(parsed.frames[0].getBody(), "Frame\0 body"s);
+    BOOST_CHECK_EQUAL(parsed.frames[1].getBody(), "Frame\0 body"s);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_frame)
+{
+    // The invalid frame is reported, and the next one is still parsed.
+    const std::string stream = "CONNECTX\n\n\0"s + messageFrame;
+    ParsedFrames parsed{};
+    auto parser = parsed.makeParser();
+    BOOST_CHECK_EQUAL(parser.push(stream), StompError::Ok);
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 2);
+    BOOST_CHECK_EQUAL(parsed.errors[0], StompError::Parsing);
+    BOOST_CHECK_EQUAL(parsed.errors[1], StompError::Ok);
+    BOOST_CHECK_EQUAL(parsed.frames[1].getBody(), "Frame body");
+}
+
+BOOST_AUTO_TEST_CASE(frame_too_large)
+{
+    ParsedFrames parsed{};
+    auto parser = parsed.makeParser(32);
+    BOOST_CHECK_EQUAL(parser.push(std::string_view(messageFrame).substr(0, 30) ), StompError::Ok);
+    BOOST_CHECK_EQUAL(parser.bufferedSize(), 30);
+    BOOST_CHECK_EQUAL(parser.push(std::string_view(messageFrame).substr(30) ), StompError::Parsing);
+    BOOST_CHECK_EQUAL(parser.bufferedSize(), 0);
+    BOOST_CHECK_EQUAL(parsed.frames.size(), 0);
+
+    // The parser can be used again after the error.
+    BOOST_CHECK_EQUAL(parser.push(std::string(receiptFrame) ), StompError::Ok);
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 1);
+    BOOST_CHECK_EQUAL(parsed.frames[0].getCommand(), StompCommand::Receipt);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StompStreamParser
+
+
+BOOST_AUTO_TEST_SUITE_END(); // stomp_stream_parser
+
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -7,10 +7,15 @@
 
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 using NetworkMonitor::Id;
+using NetworkMonitor::JourneyLeg;
 using NetworkMonitor::Line;
 using NetworkMonitor::PassengerEvent;
 using NetworkMonitor::Route;
@@ -333,6 +338,68 @@ BOOST_AUTO_TEST_CASE(basic)
     BOOST_CHECK_EQUAL(nw.getPassengerCount(station2.id), -1);
 }
 
+BOOST_AUTO_TEST_CASE(concurrent)
+{
+    TransportNetwork nw {};
+    const Station station0 {"station_000", "Station Name 0"};
+    const Station station1 {"station_001", "Station Name 1"};
+    BOOST_REQUIRE(nw.addStation(station0) );
+    BOOST_REQUIRE(nw.addStation(station1) );
+
+    // Several threads record events on the same stations at the same time.
+    using EventType = PassengerEvent::Type;
+    constexpr int threadCount {4};
+    constexpr int eventCount {10000};
+    std::vector<std::thread> threads {};
+    for(int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&nw, &station0, &station1]() {
+            for(int j = 0; j < eventCount; ++j) {
+                nw.recordPassengerEvent({station0.id, EventType::In});
+                nw.recordPassengerEvent({station1.id, EventType::Out});
+                nw.recordPassengerEvent({station1.id, EventType::In});
+            }
+        });
+    }
+    for(auto& thread : threads)
+        thread.join();
+
+    BOOST_CHECK_EQUAL(nw.getPassengerCount(station0.id), threadCount * eventCount);
+    BOOST_CHECK_EQUAL(nw.getPassengerCount(station1.id), 0);
+}
+
+BOOST_AUTO_TEST_CASE(batch)
+{
+    TransportNetwork nw {};
+    const Station station0 {"station_000", "Station Name 0"};
+    const Station station1 {"station_001", "Station Name 1"};
+    BOOST_REQUIRE(nw.addStation(station0) );
+    BOOST_REQUIRE(nw.addStation(station1) );
+
+    // Unknown stations are reported, but do not stop the rest of the batch.
+    using EventType = PassengerEvent::Type;
+    const std::vector<PassengerEvent> events {
+        {station0.id, EventType::In},
+        {station0.id, EventType::In},
+        {"station_42", EventType::In},
+        {station1.id, EventType::Out},
+        {station0.id, EventType::Out},
+        {station1.id, EventType::In},
+        {station1.id, EventType::Out},
+        {"station_43", EventType::Out},
+        {station0.id, EventType::In},
+    };
+    const auto failed = nw.recordPassengerEvents(events);
+    BOOST_CHECK(failed == std::vector<size_t>({2, 7}) );
+    BOOST_CHECK_EQUAL(nw.getPassengerCount(station0.id), 2);
+    BOOST_CHECK_EQUAL(nw.getPassengerCount(station1.id), -1);
+
+    // A second batch adds to the counts of the first one.
+    BOOST_CHECK(nw.recordPassengerEvents({{station1.id, EventType::In}}).empty() );
+    BOOST_CHECK(nw.recordPassengerEvents({}).empty() );
+    BOOST_CHECK_EQUAL(nw.getPassengerCount(station0.id), 2);
+    BOOST_CHECK_EQUAL(nw.getPassengerCount(station1.id), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // PassengerEvents
 
 BOOST_AUTO_TEST_SUITE(GetRoutesServingStation);
@@ -414,6 +481,48 @@ BOOST_AUTO_TEST_CASE(lone_station)
     BOOST_TEST(routes.empty() );
 }
 
+BOOST_AUTO_TEST_CASE(sorted_by_id)
+{
+    TransportNetwork nw{};
+
+    // The routes are added in reverse ID order.
+    // route1: 0 ---> 1
+    // route0: 1 ---> 0
+    const Station station0 {
+        "station_000",
+        "Station Name 0",
+    };
+    const Station station1 {
+        "station_001",
+        "Station Name 1",
+    };
+    const Route route1 {
+        "route_001",
+        "inbound",
+        "line_000",
+        "station_000",
+        "station_001",
+        {"station_000", "station_001"},
+    };
+    const Route route0 {
+        "route_000",
+        "outbound",
+        "line_000",
+        "station_001",
+        "station_000",
+        {"station_001", "station_000"},
+    };
+    BOOST_TEST_REQUIRE(nw.addStation(station0) );
+    BOOST_TEST_REQUIRE(nw.addStation(station1) );
+    BOOST_TEST_REQUIRE(nw.addLine({"line_000", "Line Name", {route1, route0}}) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station0.id, station1.id, 3) );
+
+    BOOST_TEST(nw.getRoutesServingStation(station0.id) == std::vector<Id>({"route_000", "route_001"}) );
+    BOOST_TEST(nw.getTravelTime("line_000", route1.id, station0.id, station1.id) == 3);
+    BOOST_TEST(nw.getTravelTime("line_000", route0.id, station1.id, station0.id) == 3);
+    BOOST_TEST(nw.getTravelTime("line_000", route0.id, station0.id, station1.id) == 0);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END(); // GetRoutesServingStation
 
@@ -595,8 +704,305 @@ BOOST_AUTO_TEST_CASE(over_route)
     );
 }
 
+BOOST_AUTO_TEST_CASE(update_over_route)
+{
+    TransportNetwork nw {};
+
+    // route0: 0 ---> 1 ---> 2 ---> 3
+    // route1: 3 ---> 2 ---> 1
+    const Station station0 {"station_000", "Station Name 0"};
+    const Station station1 {"station_001", "Station Name 1"};
+    const Station station2 {"station_002", "Station Name 2"};
+    const Station station3 {"station_003", "Station Name 3"};
+    const Route route0 {
+        "route_000",
+        "inbound",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_002", "station_003"},
+    };
+    const Route route1 {
+        "route_001",
+        "outbound",
+        "line_000",
+        "station_003",
+        "station_001",
+        {"station_003", "station_002", "station_001"},
+    };
+    const Line line {"line_000", "Line Name", {route0, route1}};
+    BOOST_TEST_REQUIRE(nw.addStation(station0) );
+    BOOST_TEST_REQUIRE(nw.addStation(station1) );
+    BOOST_TEST_REQUIRE(nw.addStation(station2) );
+    BOOST_TEST_REQUIRE(nw.addStation(station3) );
+    BOOST_TEST_REQUIRE(nw.addLine(line) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station0.id, station1.id, 1) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station1.id, station2.id, 2) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station2.id, station3.id, 3) );
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station0.id, station3.id) == 1 + 2 + 3);
+    BOOST_TEST(nw.getTravelTime(line.id, route1.id, station3.id, station1.id) == 3 + 2);
+
+    // Changing a travel time updates every route using that edge, in both directions.
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station2.id, station1.id, 10) );
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station0.id, station3.id) == 1 + 10 + 3);
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station0.id, station1.id) == 1);
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station2.id, station3.id) == 3);
+    BOOST_TEST(nw.getTravelTime(line.id, route1.id, station3.id, station1.id) == 3 + 10);
+
+    // Shorter travel times work too.
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station1.id, station2.id, 4) );
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station1.id, station3.id) == 4 + 3);
+    BOOST_TEST(nw.getTravelTime(line.id, route1.id, station2.id, station1.id) == 4);
+
+    // Travel times only go along the direction of the route.
+    BOOST_TEST(nw.getTravelTime(line.id, route1.id, station1.id, station3.id) == 0);
+    BOOST_TEST(nw.getTravelTime(line.id, route1.id, station0.id, station1.id) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(circular_route)
+{
+    TransportNetwork nw {};
+
+    // route0: 0 ---> 1 ---> 2 ---> 0 ---> 3
+    const Station station0 {"station_000", "Station Name 0"};
+    const Station station1 {"station_001", "Station Name 1"};
+    const Station station2 {"station_002", "Station Name 2"};
+    const Station station3 {"station_003", "Station Name 3"};
+    const Route route0 {
+        "route_000",
+        "inbound",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_002", "station_000", "station_003"},
+    };
+    const Line line {"line_000", "Line Name", {route0}};
+    BOOST_TEST_REQUIRE(nw.addStation(station0) );
+    BOOST_TEST_REQUIRE(nw.addStation(station1) );
+    BOOST_TEST_REQUIRE(nw.addStation(station2) );
+    BOOST_TEST_REQUIRE(nw.addStation(station3) );
+    BOOST_TEST_REQUIRE(nw.addLine(line) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station0.id, station1.id, 1) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station1.id, station2.id, 2) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station2.id, station0.id, 3) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station0.id, station3.id, 4) );
+
+    BOOST_TEST(nw.getRoutesServingStation(station0.id) == std::vector<Id>{route0.id});
+
+    // The shortest ride between the stops at each station.
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station0.id, station3.id) == 4);
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station1.id, station0.id) == 2 + 3);
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station0.id, station2.id) == 1 + 2);
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station3.id, station0.id) == 0);
+    // Not the full loop back to the same station.
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station0.id, station0.id) == 0);
+
+    // Only the stops after the changed hop shift.
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station2.id, station0.id, 10) );
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station1.id, station0.id) == 2 + 10);
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station1.id, station3.id) == 2 + 10 + 4);
+    BOOST_TEST(nw.getTravelTime(line.id, route0.id, station0.id, station3.id) == 4);
+
+    const auto journey = nw.findFastestJourney(station1.id, station3.id, 5);
+    BOOST_REQUIRE_EQUAL(journey.size(), 1);
+    BOOST_TEST(journey[0].travelTime == 2 + 10 + 4);
+
+    // A route cannot ride the same hop twice.
+    const Route route1 {
+        "route_001",
+        "inbound",
+        "line_001",
+        "station_000",
+        "station_001",
+        {"station_000", "station_001", "station_000", "station_001"},
+    };
+    BOOST_TEST(!nw.addLine({"line_001", "Line Name", {route1}}) );
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // TravelTime
 
+BOOST_AUTO_TEST_SUITE(FastestJourney);
+
+// line0, route0: 0 ---> 1 ---> 2 ---> 3
+// line1, route1: 1 ---> 4 ---> 3
+// line1, route2: 4 ---> 5
+static TransportNetwork makeJourneyNetwork()
+{
+    TransportNetwork nw {};
+    for(int i = 0; i < 6; ++i) {
+        const auto id = "station_00" + std::to_string(i);
+        BOOST_REQUIRE(nw.addStation({id, "Station Name " + std::to_string(i)}) );
+    }
+    const Route route0 {
+        "route_000",
+        "inbound",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_002", "station_003"},
+    };
+    const Route route1 {
+        "route_001",
+        "inbound",
+        "line_001",
+        "station_001",
+        "station_003",
+        {"station_001", "station_004", "station_003"},
+    };
+    const Route route2 {
+        "route_002",
+        "inbound",
+        "line_001",
+        "station_004",
+        "station_005",
+        {"station_004", "station_005"},
+    };
+    BOOST_REQUIRE(nw.addLine({"line_000", "Line Name 0", {route0}}) );
+    BOOST_REQUIRE(nw.addLine({"line_001", "Line Name 1", {route1, route2}}) );
+    bool ok = true;
+    ok &= nw.setTravelTime("station_000", "station_001", 1);
+    ok &= nw.setTravelTime("station_001", "station_002", 1);
+    ok &= nw.setTravelTime("station_002", "station_003", 10);
+    ok &= nw.setTravelTime("station_001", "station_004", 2);
+    ok &= nw.setTravelTime("station_004", "station_003", 2);
+    ok &= nw.setTravelTime("station_004", "station_005", 3);
+    BOOST_REQUIRE(ok);
+    return nw;
+}
+
+BOOST_AUTO_TEST_CASE(change_line)
+{
+    const TransportNetwork nw = makeJourneyNetwork();
+
+    // Changing to line1 at station 1 beats staying on line0.
+    const auto legs = nw.findFastestJourney("station_000", "station_003");
+    BOOST_TEST_REQUIRE(legs.size() == 2);
+    BOOST_CHECK(legs[0] == (JourneyLeg{"line_000", "route_000", "station_000", "station_001", 1}));
+    BOOST_CHECK(legs[1] == (JourneyLeg{"line_001", "route_001", "station_001", "station_003", 4}));
+}
+
+BOOST_AUTO_TEST_CASE(line_change_penalty)
+{
+    const TransportNetwork nw = makeJourneyNetwork();
+
+    // With a large enough penalty, staying on line0 is faster.
+    const auto legs = nw.findFastestJourney("station_000", "station_003", 10);
+    BOOST_TEST_REQUIRE(legs.size() == 1);
+    BOOST_CHECK(legs[0] == (JourneyLeg{"line_000", "route_000", "station_000", "station_003", 12}));
+
+    // Changing route within the same line is not penalised.
+    const auto sameLineLegs = nw.findFastestJourney("station_001", "station_005", 10);
+    BOOST_TEST_REQUIRE(sameLineLegs.size() == 2);
+    BOOST_CHECK(sameLineLegs[0] == (JourneyLeg{"line_001", "route_001", "station_001", "station_004", 2}));
+    BOOST_CHECK(sameLineLegs[1] == (JourneyLeg{"line_001", "route_002", "station_004", "station_005", 3}));
+}
+
+BOOST_AUTO_TEST_CASE(no_journey)
+{
+    const TransportNetwork nw = makeJourneyNetwork();
+
+    // Routes only go one way.
+    BOOST_TEST(nw.findFastestJourney("station_003", "station_000").empty() );
+    // Same station.
+    BOOST_TEST(nw.findFastestJourney("station_001", "station_001").empty() );
+    // Unknown station.
+    BOOST_TEST(nw.findFastestJourney("station_000", "station_42").empty() );
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // FastestJourney
+
+BOOST_AUTO_TEST_SUITE(Indices);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    TransportNetwork nw {};
+
+    // route0: 0 ---> 1 ---> 2
+    const Station station0 {"station_000", "Station Name 0"};
+    const Station station1 {"station_001", "Station Name 1"};
+    const Station station2 {"station_002", "Station Name 2"};
+    const Route route0 {
+        "route_000",
+        "inbound",
+        "line_000",
+        "station_000",
+        "station_002",
+        {"station_000", "station_001", "station_002"},
+    };
+    const Line line {"line_000", "Line Name", {route0}};
+    BOOST_TEST_REQUIRE(nw.addStation(station0) );
+    BOOST_TEST_REQUIRE(nw.addStation(station1) );
+    BOOST_TEST_REQUIRE(nw.addStation(station2) );
+    BOOST_TEST_REQUIRE(nw.addLine(line) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station0.id, station1.id, 1) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station1.id, station2.id, 2) );
+
+    // Indices are dense and assigned in insertion order.
+    BOOST_TEST(nw.getStationIndex(station0.id).value() == 0);
+    BOOST_TEST(nw.getStationIndex(station1.id).value() == 1);
+    BOOST_TEST(nw.getStationIndex(station2.id).value() == 2);
+    BOOST_TEST(nw.getRouteIndex(route0.id).value() == 0);
+    BOOST_TEST(!nw.getStationIndex("station_42").has_value() );
+    BOOST_TEST(!nw.getRouteIndex("route_42").has_value() );
+
+    // The index queries agree with the string ones.
+    const auto index0 = nw.getStationIndex(station0.id).value();
+    const auto index1 = nw.getStationIndex(station1.id).value();
+    const auto index2 = nw.getStationIndex(station2.id).value();
+    const auto routeIndex = nw.getRouteIndex(route0.id).value();
+    BOOST_TEST(nw.getAdjacentTravelTime(index1, index0) == 1);
+    BOOST_TEST(nw.getAdjacentTravelTime(index0, index2) == 0);
+    BOOST_TEST(nw.getTravelTime(routeIndex, index0, index2) == 1 + 2);
+    BOOST_TEST(nw.getTravelTime(routeIndex, index2, index0) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(add_line_after_travel_times)
+{
+    TransportNetwork nw {};
+
+    // route0: 0 ---> 1
+    // route1: 1 ---> 0 ---> 2, added after the travel times are set.
+    const Station station0 {"station_000", "Station Name 0"};
+    const Station station1 {"station_001", "Station Name 1"};
+    const Station station2 {"station_002", "Station Name 2"};
+    const Route route0 {
+        "route_000",
+        "inbound",
+        "line_000",
+        "station_000",
+        "station_001",
+        {"station_000", "station_001"},
+    };
+    const Route route1 {
+        "route_001",
+        "outbound",
+        "line_001",
+        "station_001",
+        "station_002",
+        {"station_001", "station_000", "station_002"},
+    };
+    BOOST_TEST_REQUIRE(nw.addStation(station0) );
+    BOOST_TEST_REQUIRE(nw.addStation(station1) );
+    BOOST_TEST_REQUIRE(nw.addLine({"line_000", "Line Name 0", {route0}}) );
+    BOOST_TEST_REQUIRE(nw.setTravelTime(station0.id, station1.id, 5) );
+
+    // station_002 is not in the network yet, so the whole line is rejected.
+    BOOST_TEST(!nw.addLine({"line_001", "Line Name 1", {route1}}) );
+    BOOST_TEST(!nw.getRouteIndex(route1.id).has_value() );
+    BOOST_TEST(nw.getRoutesServingStation(station0.id) == std::vector<Id>({"route_000"}) );
+
+    // Once it is there, the existing travel times survive the new line.
+    BOOST_TEST_REQUIRE(nw.addStation(station2) );
+    BOOST_TEST_REQUIRE(nw.addLine({"line_001", "Line Name 1", {route1}}) );
+    BOOST_TEST(nw.getAdjacentTravelTime(station0.id, station1.id) == 5);
+    BOOST_TEST(nw.getTravelTime("line_001", route1.id, station1.id, station0.id) == 5);
+    BOOST_TEST(
+        nw.getRoutesServingStation(station0.id) == std::vector<Id>({"route_000", "route_001"})
+    );
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // Indices
+
 
 BOOST_AUTO_TEST_SUITE(FromJson);
 
@@ -714,6 +1120,233 @@ BOOST_AUTO_TEST_CASE(fail_on_bad_travel_times)
 
 BOOST_AUTO_TEST_SUITE_END(); // FromJson
 
+BOOST_AUTO_TEST_SUITE(FromJsonStream);
+
+BOOST_AUTO_TEST_CASE(from_json_file_2lines_2routes)
+{
+    const auto testFilePath = std::filesystem::path(TEST_DATA) / "from_json_2lines_2routes.json";
+    TransportNetwork nw{};
+    BOOST_TEST_REQUIRE(nw.fromJsonFile(testFilePath) );
+
+    std::vector<Id> routes {};
+    routes = nw.getRoutesServingStation("station_0");
+    BOOST_TEST_REQUIRE(routes.size() ==  2);
+    BOOST_TEST(routes[0] == "route_0");
+    BOOST_TEST(routes[1] == "route_1");
+    routes = nw.getRoutesServingStation("station_1");
+    BOOST_TEST_REQUIRE(routes.size() == 2);
+    BOOST_TEST(routes[0] == "route_0");
+    BOOST_TEST(routes[1] == "route_1");
+}
+
+BOOST_AUTO_TEST_CASE(from_json_file_travel_times)
+{
+    const auto testFilePath = std::filesystem::path(TEST_DATA) / "from_json_travel_times.json";
+    TransportNetwork nw{};
+    BOOST_TEST_REQUIRE(nw.fromJsonFile(testFilePath) );
+
+    BOOST_TEST(nw.getAdjacentTravelTime("station_0", "station_1") == 1);
+    BOOST_TEST(nw.getAdjacentTravelTime("station_1", "station_0") == 1);
+    BOOST_TEST(nw.getAdjacentTravelTime("station_1", "station_2") == 2);
+    BOOST_TEST(nw.getTravelTime("line_0", "route_0", "station_0", "station_2") == 1 + 2);
+}
+
+BOOST_AUTO_TEST_CASE(same_as_from_json)
+{
+    // Load the full network layout both ways.
+    TransportNetwork nwStream{};
+    BOOST_TEST_REQUIRE(nwStream.fromJsonFile(TEST_NETWORK_LAYOUT) );
+    auto src = parseJsonFile(TEST_NETWORK_LAYOUT);
+    const auto stations = src.at("stations");
+    const auto travelTimes = src.at("travel_times");
+    TransportNetwork nwJson{};
+    BOOST_TEST_REQUIRE(nwJson.fromJson(std::move(src) ) );
+
+    for(const auto& station : stations) {
+        const Id id = station.at("station_id");
+        BOOST_CHECK(nwStream.getStationIndex(id) == nwJson.getStationIndex(id) );
+        BOOST_TEST(nwStream.getRoutesServingStation(id) == nwJson.getRoutesServingStation(id) );
+    }
+    for(const auto& travelTime : travelTimes) {
+        const Id stationA = travelTime.at("start_station_id");
+        const Id stationB = travelTime.at("end_station_id");
+        BOOST_TEST(
+            nwStream.getAdjacentTravelTime(stationA, stationB) == nwJson.getAdjacentTravelTime(stationA, stationB)
+        );
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_bad_json)
+{
+    TransportNetwork nw{};
+    std::istringstream truncated {R"({"stations": [{"station_id": "station_0")"};
+    BOOST_CHECK_THROW(nw.fromJsonStream(truncated), nlohmann::json::parse_error);
+
+    std::istringstream overflow {R"({"stations": [], "lines": [], "travel_times": [1e400]})"};
+    BOOST_CHECK_THROW(nw.fromJsonStream(overflow), nlohmann::json::out_of_range);
+
+    // Missing "stations"!
+    std::istringstream missingStations {R"({"lines": [], "travel_times": []})"};
+    BOOST_CHECK_THROW(nw.fromJsonStream(missingStations), std::runtime_error);
+
+    BOOST_CHECK_THROW(nw.fromJsonFile(std::filesystem::path(TEST_DATA) / "missing.json"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_good_json_bad_items)
+{
+    TransportNetwork nw{};
+    std::istringstream duplicateStation {R"({
+        "stations": [
+            {"station_id": "station_0", "name": "Station 0 Name"},
+            {"station_id": "station_0", "name": "Station 0 Name"}
+        ],
+        "lines": [],
+        "travel_times": []
+    })"};
+    BOOST_CHECK_THROW(nw.fromJsonStream(duplicateStation), std::runtime_error);
+
+    std::istringstream missingName {R"({
+        "stations": [
+            {"station_id": "station_0"}
+        ],
+        "lines": [],
+        "travel_times": []
+    })"};
+    BOOST_CHECK_THROW(nw.fromJsonStream(missingName), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_bad_travel_times)
+{
+    const auto testFilePath = std::filesystem::path(TEST_DATA) / "from_json_bad_travel_times.json";
+    TransportNetwork nw{};
+    BOOST_TEST_REQUIRE(!nw.fromJsonFile(testFilePath) );
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // FromJsonStream
+
+BOOST_AUTO_TEST_SUITE(Snapshot);
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+    TransportNetwork nw{};
+    BOOST_TEST_REQUIRE(nw.fromJsonFile(TEST_NETWORK_LAYOUT) );
+    BOOST_TEST_REQUIRE(nw.recordPassengerEvent({"station_000", PassengerEvent::Type::In}) );
+    const auto snapshotPath = std::filesystem::temp_directory_path() / "network-layout.snapshot";
+    BOOST_TEST_REQUIRE(nw.saveSnapshot(snapshotPath) );
+
+    TransportNetwork loaded{};
+    BOOST_TEST_REQUIRE(loaded.loadSnapshot(snapshotPath) );
+    std::filesystem::remove(snapshotPath);
+
+    const auto src = parseJsonFile(TEST_NETWORK_LAYOUT);
+    for(const auto& station : src.at("stations") ) {
+        const Id id = station.at("station_id");
+        BOOST_CHECK(loaded.getStationIndex(id) == nw.getStationIndex(id) );
+        BOOST_TEST(loaded.getRoutesServingStation(id) == nw.getRoutesServingStation(id) );
+    }
+    for(const auto& travelTime : src.at("travel_times") ) {
+        const Id stationA = travelTime.at("start_station_id");
+        const Id stationB = travelTime.at("end_station_id");
+        BOOST_TEST(loaded.getAdjacentTravelTime(stationA, stationB) == nw.getAdjacentTravelTime(stationA, stationB) );
+        const Id line = travelTime.at("line_id");
+        const Id route = travelTime.at("route_id");
+        BOOST_TEST(
+            loaded.getTravelTime(line, route, stationA, stationB) == nw.getTravelTime(line, route, stationA, stationB)
+        );
+    }
+    BOOST_CHECK(
+        loaded.findFastestJourney("station_000", "station_100", 5) == nw.findFastestJourney("station_000", "station_100", 5)
+    );
+
+    // Passenger counts are not part of the snapshot.
+    BOOST_TEST(loaded.getPassengerCount("station_000") == 0);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_bad_file)
+{
+    TransportNetwork nw{};
+    BOOST_TEST_REQUIRE(nw.fromJsonFile(std::filesystem::path(TEST_DATA) / "from_json_travel_times.json") );
+    const auto snapshotPath = std::filesystem::temp_directory_path() / "from_json_travel_times.snapshot";
+    BOOST_TEST_REQUIRE(nw.saveSnapshot(snapshotPath) );
+
+    std::string snapshot {};
+    {
+        std::ifstream file {snapshotPath, std::ios::binary};
+        snapshot.assign(std::istreambuf_iterator<char>(file), {});
+    }
+    const auto writeSnapshot = [&snapshotPath](const std::string& content) {
+        std::ofstream file {snapshotPath, std::ios::binary | std::ios::trunc};
+        file << content;
+    };
+
+    // A failed load leaves the network untouched.
+    TransportNetwork loaded{};
+    BOOST_TEST_REQUIRE(loaded.addStation({"station_42", "Station Name 42"}) );
+
+    // Corrupted data.
+    std::string corrupted = snapshot;
+    corrupted.back() ^= 1;
+    writeSnapshot(corrupted);
+    BOOST_TEST(!loaded.loadSnapshot(snapshotPath) );
+
+    // Another version.
+    std::string otherVersion = snapshot;
+    otherVersion[8] ^= 1;
+    writeSnapshot(otherVersion);
+    BOOST_TEST(!loaded.loadSnapshot(snapshotPath) );
+
+    // Truncated.
+    writeSnapshot(snapshot.substr(0, snapshot.size() / 2) );
+    BOOST_TEST(!loaded.loadSnapshot(snapshotPath) );
+
+    // Missing.
+    std::filesystem::remove(snapshotPath);
+    BOOST_TEST(!loaded.loadSnapshot(snapshotPath) );
+
+    BOOST_TEST(loaded.getStationIndex("station_42").has_value() );
+    BOOST_TEST(!loaded.getStationIndex("station_0").has_value() );
+}
+
+BOOST_AUTO_TEST_CASE(empty_sections)
+{
+    // Without lines, the route and edge sections are empty.
+    TransportNetwork nw{};
+    BOOST_TEST_REQUIRE(nw.addStation({"station_000", "Station Name 0"}) );
+    const auto snapshotPath = std::filesystem::temp_directory_path() / "lone-station.snapshot";
+    BOOST_TEST_REQUIRE(nw.saveSnapshot(snapshotPath) );
+
+    TransportNetwork loaded{};
+    BOOST_TEST_REQUIRE(loaded.loadSnapshot(snapshotPath) );
+    std::filesystem::remove(snapshotPath);
+    BOOST_TEST(loaded.getStationIndex("station_000").has_value() );
+    BOOST_TEST(loaded.getRoutesServingStation("station_000").empty() );
+}
+
+BOOST_AUTO_TEST_CASE(failed_save_keeps_previous)
+{
+    TransportNetwork nw{};
+    BOOST_TEST_REQUIRE(nw.fromJsonFile(std::filesystem::path(TEST_DATA) / "from_json_travel_times.json") );
+    const auto snapshotPath = std::filesystem::temp_directory_path() / "failed-save.snapshot";
+    BOOST_TEST_REQUIRE(nw.saveSnapshot(snapshotPath) );
+
+    // The temporary file cannot be created where a directory is.
+    auto tmpPath = snapshotPath;
+    tmpPath += ".tmp";
+    std::filesystem::create_directory(tmpPath);
+    TransportNetwork other{};
+    BOOST_TEST_REQUIRE(other.addStation({"station_42", "Station Name 42"}) );
+    BOOST_TEST(!other.saveSnapshot(snapshotPath) );
+    std::filesystem::remove(tmpPath);
+
+    TransportNetwork loaded{};
+    BOOST_TEST_REQUIRE(loaded.loadSnapshot(snapshotPath) );
+    std::filesystem::remove(snapshotPath);
+    BOOST_TEST(loaded.getStationIndex("station_0").has_value() );
+    BOOST_TEST(!loaded.getStationIndex("station_42").has_value() );
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // Snapshot
+
 
 BOOST_AUTO_TEST_SUITE_END(); // class_TransportNetwork
 
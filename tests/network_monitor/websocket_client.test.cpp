@@ -1,5 +1,6 @@
 
 #include "boost_mock.hpp"
+#include "loopback_server.hpp"
 
 #include <network_monitor/websocket_client.hpp>
 
@@ -9,10 +10,13 @@
 
 #include <chrono>
 #include <filesystem>
+#include <functional>
 #include <mutex>
 #include <string>
+#include <vector>
 
 using NetworkMonitor::BoostWebSocketClient;
+using NetworkMonitor::LoopbackServer;
 
 using NetworkMonitor::MockResolver;
 using NetworkMonitor::MockTcpStream;
@@ -25,6 +29,10 @@ struct WebSocketClientTestFixture {
     WebSocketClientTestFixture()
     {
         MockResolver::s_resolveEc = {};
+        MockResolver::s_endpoints = {
+            {boost::asio::ip::make_address("127.0.0.1"), 443}
+        };
+        MockResolver::s_resolveCount = 0;
         MockTcpStream::s_connectEc = {};
         MockTlsStream::s_handshakeEc = {};
         MockTlsWebSocketStream::s_handshakeEc = {};
@@ -160,6 +168,33 @@ BOOST_AUTO_TEST_CASE(fail_websocket_handshake, *timeout {1})
     BOOST_CHECK(calledOnConnect);
 }
 
+BOOST_AUTO_TEST_CASE(fail_no_endpoints, *timeout {1})
+{
+    // We use the mock client so we don't really connect to the target.
+    const std::string url {"some.echo-server.com"};
+    const std::string endpoint {"/"};
+    const std::string port {"443"};
+
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+    boost::asio::io_context ioc {};
+
+    // The name resolves, but to no address.
+    MockResolver::s_endpoints = {};
+
+    TestWebSocketClient client {url, endpoint, port, ioc, ctx};
+    bool calledOnConnect {false};
+    auto onConnect {[&calledOnConnect](auto ec) {
+        calledOnConnect = true;
+        BOOST_CHECK_EQUAL(ec, boost::asio::error::host_not_found);
+    }};
+    client.connect(onConnect);
+    ioc.run();
+
+    // When we get here, the io_context::run function has run out of work to do.
+    BOOST_CHECK(calledOnConnect);
+}
+
 BOOST_AUTO_TEST_CASE(successful_nothing_to_read, *timeout {1})
 {
     // We use the mock client so we don't really connect to the target.
@@ -222,6 +257,141 @@ BOOST_AUTO_TEST_CASE(successful_no_connecthandler, *timeout {1})
     BOOST_CHECK(didTimeout);
 }
 
+BOOST_AUTO_TEST_CASE(reconnect_reuses_endpoints, *timeout {1})
+{
+    // We use the mock client so we don't really connect to the target.
+    const std::string url {"some.echo-server.com"};
+    const std::string endpoint {"/"};
+    const std::string port {"443"};
+
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+    boost::asio::io_context ioc {};
+
+    TestWebSocketClient client {url, endpoint, port, ioc, ctx};
+    size_t nConnections {0};
+    std::function<void (boost::system::error_code)> onConnect;
+    onConnect = [&nConnections, &client, &onConnect](auto ec) {
+        ++nConnections;
+        BOOST_CHECK(!ec);
+        client.close([&nConnections, &client, &onConnect](auto ec) {
+            BOOST_CHECK(!ec);
+            if (nConnections == 1) {
+                // The second connection must not resolve the name again.
+                MockResolver::s_resolveEc = boost::asio::error::host_not_found;
+                client.connect(onConnect);
+            }
+        });
+    };
+    client.connect(onConnect);
+    ioc.run();
+
+    // When we get here, the io_context::run function has run out of work to do.
+    BOOST_CHECK_EQUAL(nConnections, 2);
+}
+
+BOOST_AUTO_TEST_CASE(reconnect_before_close, *timeout {1})
+{
+    // We use the mock client so we don't really connect to the target.
+    const std::string url {"some.echo-server.com"};
+    const std::string endpoint {"/"};
+    const std::string port {"443"};
+
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+    boost::asio::io_context ioc {};
+
+    // The stream is still reading: it cannot be replaced by a new connection.
+    TestWebSocketClient client {url, endpoint, port, ioc, ctx};
+    bool calledOnRefused {false};
+    bool calledOnClose {false};
+    auto onConnect {[&client, &calledOnRefused, &calledOnClose](auto ec) {
+        BOOST_REQUIRE(!ec);
+        client.connect([&client, &calledOnRefused, &calledOnClose](auto ec) {
+            calledOnRefused = true;
+            BOOST_CHECK(ec == boost::asio::error::in_progress);
+            client.close([&calledOnClose](auto ec) {
+                calledOnClose = true;
+                BOOST_CHECK(!ec);
+            });
+        });
+    }};
+    client.connect(onConnect);
+    ioc.run();
+
+    // When we get here, the io_context::run function has run out of work to do.
+    BOOST_CHECK(calledOnRefused);
+    BOOST_CHECK(calledOnClose);
+}
+
+BOOST_AUTO_TEST_CASE(resolve_cache_ttl, *timeout {1})
+{
+    // We use the mock client so we don't really connect to the target.
+    const std::string url {"some.echo-server.com"};
+    const std::string endpoint {"/"};
+    const std::string port {"443"};
+
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+    boost::asio::io_context ioc {};
+
+    // With no TTL, every connection resolves the name.
+    TestWebSocketClient client {url, endpoint, port, ioc, ctx};
+    client.setResolveCacheTtl(std::chrono::seconds {0});
+    size_t nConnections {0};
+    std::function<void (boost::system::error_code)> onConnect;
+    onConnect = [&nConnections, &client, &onConnect](auto ec) {
+        ++nConnections;
+        BOOST_CHECK(!ec);
+        client.close([&nConnections, &client, &onConnect](auto ec) {
+            if (nConnections == 1) {
+                client.connect(onConnect);
+            }
+        });
+    };
+    client.connect(onConnect);
+    ioc.run();
+
+    BOOST_CHECK_EQUAL(nConnections, 2);
+    BOOST_CHECK_EQUAL(MockResolver::s_resolveCount, 2);
+}
+
+BOOST_AUTO_TEST_CASE(compression, *timeout {1})
+{
+    // We use the mock client so we don't really connect to the target.
+    const std::string url {"some.echo-server.com"};
+    const std::string endpoint {"/"};
+    const std::string port {"443"};
+
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+    boost::asio::io_context ioc {};
+
+    TestWebSocketClient client {url, endpoint, port, ioc, ctx};
+    NetworkMonitor::WebSocketCompression compression {};
+    compression.enabled = true;
+    compression.windowBits = 8;
+    BOOST_CHECK(!client.setCompression(compression) );
+    compression.windowBits = 10;
+    compression.memLevel = 0;
+    BOOST_CHECK(!client.setCompression(compression) );
+    compression.memLevel = 2;
+    compression.level = 10;
+    BOOST_CHECK(!client.setCompression(compression) );
+    compression.level = 1;
+    compression.noContextTakeover = true;
+    BOOST_CHECK(client.setCompression(compression) );
+
+    bool calledOnConnect {false};
+    client.connect([&calledOnConnect, &client](auto ec) {
+        calledOnConnect = true;
+        BOOST_CHECK(!ec);
+        client.close();
+    });
+    ioc.run();
+    BOOST_CHECK(calledOnConnect);
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // Connect
 
 BOOST_FIXTURE_TEST_SUITE(onMessage, WebSocketClientTestFixture);
@@ -258,6 +428,39 @@ BOOST_AUTO_TEST_CASE(one_message, *timeout {1})
     BOOST_CHECK(calledOnMessage);
 }
 
+BOOST_AUTO_TEST_CASE(connection_latency, *timeout {1})
+{
+    // We use the mock client so we don't really connect to the target.
+    const std::string url {"some.echo-server.com"};
+    const std::string endpoint {"/"};
+    const std::string port {"443"};
+    const std::string message {"Hello WebSocket"};
+
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+    boost::asio::io_context ioc {};
+
+    MockTlsWebSocketStream::s_readBuffer = message;
+
+    TestWebSocketClient client {url, endpoint, port, ioc, ctx};
+    size_t nMessages {0};
+    auto onMessage {[&nMessages, &client](auto ec, auto msg) {
+        ++nMessages;
+        client.close();
+    }};
+    client.connect(nullptr, onMessage);
+    ioc.run();
+
+    // Each stage is recorded once per connection.
+    BOOST_REQUIRE_EQUAL(nMessages, 1);
+    const auto& latency {client.getConnectionLatency()};
+    BOOST_CHECK_EQUAL(latency.resolve.count(), 1);
+    BOOST_CHECK_EQUAL(latency.tcpConnect.count(), 1);
+    BOOST_CHECK_EQUAL(latency.tlsHandshake.count(), 1);
+    BOOST_CHECK_EQUAL(latency.wsUpgrade.count(), 1);
+    BOOST_CHECK_EQUAL(latency.firstMessage.count(), 1);
+}
+
 BOOST_AUTO_TEST_CASE(two_messages, *timeout {1})
 {
     // We use the mock client so we don't really connect to the target.
@@ -429,6 +632,42 @@ BOOST_AUTO_TEST_CASE(one_message, *timeout {1})
     BOOST_CHECK(calledOnSend);
 }
 
+BOOST_AUTO_TEST_CASE(queued_messages, *timeout {1})
+{
+    // We use the mock client so we don't really connect to the target.
+    const std::string url {"some.echo-server.com"};
+    const std::string endpoint {"/"};
+    const std::string port {"443"};
+
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+    boost::asio::io_context ioc {};
+
+    // We don't set any error code because we expect the connection to succeed.
+
+    TestWebSocketClient client {url, endpoint, port, ioc, ctx};
+    std::vector<size_t> sent {};
+    client.connect([&client, &sent](auto ec) {
+        BOOST_REQUIRE(!ec);
+        // The messages are temporaries: the client keeps them until they are written.
+        for (size_t i {0}; i < 3; ++i) {
+            client.send("Message " + std::to_string(i), [&client, &sent, i](auto ec) {
+                BOOST_CHECK(!ec);
+                sent.push_back(i);
+                if (sent.size() == 3) {
+                    // This test assumes that Close() works.
+                    client.close();
+                }
+            });
+        }
+    });
+    ioc.run();
+
+    // When we get here, the io_context::run function has run out of work to do.
+    const std::vector<size_t> expected {0, 1, 2};
+    BOOST_CHECK_EQUAL_COLLECTIONS(sent.begin(), sent.end(), expected.begin(), expected.end() );
+}
+
 BOOST_AUTO_TEST_CASE(fail, *timeout {1})
 {
     // We use the mock client so we don't really connect to the target.
@@ -570,6 +809,123 @@ BOOST_AUTO_TEST_CASE(close_no_disconnect, *timeout {1})
 
 BOOST_AUTO_TEST_SUITE_END(); // Close
 
+BOOST_FIXTURE_TEST_SUITE(loopback, WebSocketClientTestFixture);
+
+// The real stream, with endpoints chosen by the test.
+using RacingWebSocketClient = NetworkMonitor::WebSocketClient<
+    MockResolver,
+    boost::beast::websocket::stream<
+        boost::beast::ssl_stream<boost::beast::tcp_stream>
+    >
+>;
+
+BOOST_AUTO_TEST_CASE(race_skips_refused_endpoint, *timeout {1})
+{
+    boost::asio::io_context ioc {};
+    LoopbackServer server {ioc, [](auto&&...) {}};
+
+    // Nothing listens on this port any more.
+    boost::asio::ip::tcp::endpoint refused {};
+    {
+        boost::asio::ip::tcp::acceptor acceptor {ioc, {
+            boost::asio::ip::make_address("127.0.0.1"), 0
+        }};
+        refused = acceptor.local_endpoint();
+    }
+    MockResolver::s_endpoints = {
+        refused,
+        {boost::asio::ip::make_address("127.0.0.1"), server.port()},
+    };
+
+    // The second endpoint is tried as soon as the first one fails, without
+    // waiting for the attempt delay.
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    RacingWebSocketClient client {"127.0.0.1", "/", "0", ioc, ctx};
+    client.setConnectionAttemptDelay(std::chrono::seconds {10});
+    bool connected {false};
+    client.connect([&](auto ec) {
+        BOOST_REQUIRE(!ec);
+        connected = true;
+        client.close([&ioc](auto ec) {
+            ioc.stop();
+        });
+    });
+    ioc.run();
+    BOOST_CHECK(connected);
+}
+
+BOOST_AUTO_TEST_CASE(race_staggers_slow_endpoint, *timeout {2})
+{
+    boost::asio::io_context ioc {};
+    LoopbackServer server {ioc, [](auto&&...) {}};
+
+    // A listener that never accepts, with a full backlog: the kernel drops the
+    // next connection requests, which stall until the 5 s attempt timeout.
+    boost::asio::ip::tcp::acceptor stalled {ioc};
+    stalled.open(boost::asio::ip::tcp::v4());
+    stalled.bind({boost::asio::ip::make_address("127.0.0.1"), 0});
+    stalled.listen(0);
+    boost::asio::ip::tcp::socket backlog {ioc};
+    backlog.connect(stalled.local_endpoint());
+    MockResolver::s_endpoints = {
+        stalled.local_endpoint(),
+        {boost::asio::ip::make_address("127.0.0.1"), server.port()},
+    };
+
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    RacingWebSocketClient client {"127.0.0.1", "/", "0", ioc, ctx};
+    client.setConnectionAttemptDelay(std::chrono::milliseconds {50});
+    bool connected {false};
+    const auto start {std::chrono::steady_clock::now()};
+    client.connect([&](auto ec) {
+        BOOST_REQUIRE(!ec);
+        connected = true;
+        client.close([&ioc](auto ec) {
+            ioc.stop();
+        });
+    });
+    ioc.run();
+    BOOST_CHECK(connected);
+    BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds {1});
+}
+
+BOOST_AUTO_TEST_CASE(tls_session_resumption, *timeout {5})
+{
+    boost::asio::io_context ioc {};
+    LoopbackServer server {ioc, [](auto&&...) {}};
+
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    BoostWebSocketClient client {
+        "127.0.0.1", "/", std::to_string(server.port()), ioc, ctx
+    };
+    const size_t nConnections {3};
+    size_t nConnected {0};
+    std::function<void (boost::system::error_code)> onConnect;
+    onConnect = [&](auto ec) {
+        BOOST_REQUIRE(!ec);
+        ++nConnected;
+        client.close([&](auto ec) {
+            if (nConnected < nConnections) {
+                client.connect(onConnect);
+            } else {
+                ioc.stop();
+            }
+        });
+    };
+    client.connect(onConnect);
+    ioc.run();
+
+    // Every connection after the first one resumes the session of the previous one.
+    BOOST_REQUIRE_EQUAL(nConnected, nConnections);
+    const auto& stats {client.getTlsResumptionStats()};
+    BOOST_CHECK_EQUAL(stats.handshakes, nConnections);
+    BOOST_CHECK_EQUAL(stats.offered, nConnections - 1);
+    BOOST_CHECK_EQUAL(stats.resumed, nConnections - 1);
+    BOOST_CHECK_EQUAL(stats.hitRate(), 1.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // loopback
+
 BOOST_AUTO_TEST_SUITE(live);
 
 BOOST_AUTO_TEST_CASE(echo, *timeout {20})
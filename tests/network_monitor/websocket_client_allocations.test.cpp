@@ -0,0 +1,148 @@
+// This test replaces the global allocation functions, so it runs in its own
+// executable instead of changing them for the whole test suite.
+#define BOOST_TEST_MODULE websocket_client_allocations
+#include <boost/test/unit_test.hpp>
+
+#include "boost_mock.hpp"
+
+#include <network_monitor/websocket_client.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+
+using NetworkMonitor::MockResolver;
+using NetworkMonitor::MockTcpStream;
+using NetworkMonitor::MockTlsStream;
+using NetworkMonitor::MockTlsWebSocketStream;
+using NetworkMonitor::TestWebSocketClient;
+
+// Count the allocations of the test binary while enabled.
+static bool s_countAllocations {false};
+static size_t s_allocations {0};
+
+void* operator new(size_t size)
+{
+    if (s_countAllocations) {
+        ++s_allocations;
+    }
+    if (void* ptr {std::malloc(size == 0 ? 1 : size)}) {
+        return ptr;
+    }
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// This fixture is used to re-initialize all mock properties before a test.
+struct WebSocketClientTestFixture {
+    WebSocketClientTestFixture()
+    {
+        MockResolver::s_resolveEc = {};
+        MockResolver::s_endpoints = {
+            {boost::asio::ip::make_address("127.0.0.1"), 443}
+        };
+        MockResolver::s_resolveCount = 0;
+        MockTcpStream::s_connectEc = {};
+        MockTlsStream::s_handshakeEc = {};
+        MockTlsWebSocketStream::s_handshakeEc = {};
+        MockTlsWebSocketStream::s_readEc = {};
+        MockTlsWebSocketStream::s_readBuffer = "";
+        MockTlsWebSocketStream::s_writeEc = {};
+        MockTlsWebSocketStream::s_closeEc = {};
+    }
+};
+
+using timeout = boost::unit_test::timeout;
+
+// Receive 110 messages, and count the allocations made for the last 100 of
+// them.
+static size_t CountReadAllocations(bool useView)
+{
+    // We use the mock client so we don't really connect to the target.
+    const std::string url {"some.echo-server.com"};
+    const std::string endpoint {"/"};
+    const std::string port {"443"};
+    // Too long for the small string optimisation.
+    const std::string message(64, 'x');
+
+    boost::asio::ssl::context ctx {boost::asio::ssl::context::tlsv12_client};
+    ctx.load_verify_file(TEST_CACERT_PEM);
+    boost::asio::io_context ioc {};
+
+    MockTlsWebSocketStream::s_readBuffer = message;
+
+    TestWebSocketClient client {url, endpoint, port, ioc, ctx};
+    size_t nMessages {0};
+    bool allReceived {true};
+    size_t allocations {0};
+    auto onMessage {[&](auto ec, auto msg) {
+        // No Boost.Test checks here: they may allocate.
+        allReceived = allReceived && !ec && msg == message;
+        ++nMessages;
+        if (nMessages == 10) {
+            s_allocations = 0;
+            s_countAllocations = true;
+        } else if (nMessages == 110) {
+            s_countAllocations = false;
+            allocations = s_allocations;
+            client.close();
+            return;
+        }
+        // The mock empties this buffer but keeps its capacity, so this does
+        // not allocate.
+        MockTlsWebSocketStream::s_readBuffer.assign(message);
+    }};
+    if (useView) {
+        client.setOnMessageView([&onMessage](auto ec, std::string_view msg) {
+            onMessage(ec, msg);
+        });
+        client.connect();
+    } else {
+        client.connect(nullptr, [&onMessage](auto ec, std::string&& msg) {
+            onMessage(ec, std::string_view {msg});
+        });
+    }
+    ioc.run();
+
+    BOOST_CHECK(allReceived);
+    BOOST_CHECK_EQUAL(nMessages, 110);
+    return allocations;
+}
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_WebSocketClient);
+
+BOOST_FIXTURE_TEST_SUITE(onMessage, WebSocketClientTestFixture);
+
+BOOST_AUTO_TEST_CASE(view_does_not_allocate, *timeout {1})
+{
+    // The mock stream posts through the type-erased strand executor, which
+    // may allocate depending on the Boost version. This costs the same with
+    // both handlers, so the difference is what the read path allocates.
+    const size_t withString {CountReadAllocations(false)};
+    const size_t withView {CountReadAllocations(true)};
+
+    // Each of the 100 messages was copied into a new string, and the view
+    // handler allocates nothing instead: the read buffer is reused.
+    BOOST_CHECK_EQUAL(withString - withView, 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // onMessage
+
+BOOST_AUTO_TEST_SUITE_END(); // class_WebSocketClient
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -62,6 +62,7 @@ void MockWebSocketClient::connect(
             m_ioc,
             [this, onConnect]() {
                 m_isConnected = true;
+                m_isClosed = false;
                 if (onConnect) {
                     onConnect(s_connectEc);
                 }
@@ -104,6 +105,11 @@ void MockWebSocketClient::send(
     }
 }
 
+boost::asio::strand<boost::asio::io_context::executor_type> MockWebSocketClient::getExecutor()
+{
+    return m_ioc;
+}
+
 void MockWebSocketClient::close(
     std::function<void (boost::system::error_code)> onClose
 )
@@ -142,6 +148,7 @@ void MockWebSocketClient::mockIncomingMessages(
 {
     if (!m_isConnected || s_triggerDisconnection) {
         s_triggerDisconnection = false;
+        m_isConnected = false;
         boost::asio::post(
             m_ioc,
             [onDisconnect, closed = m_isClosed]() {
@@ -176,6 +183,8 @@ std::string MockWebSocketClientForStomp::s_endpoint = "";
 std::string MockWebSocketClientForStomp::s_username = "";
 std::string MockWebSocketClientForStomp::s_password = "";
 std::vector<std::string> MockWebSocketClientForStomp::s_subscriptionMessages = {};
+std::string MockWebSocketClientForStomp::s_heartBeat = {};
+int MockWebSocketClientForStomp::s_heartBeatsReceived = 0;
 
 // Public methods
 
@@ -207,6 +216,17 @@ StompFrame MockWebSocketClientForStomp::makeConnectedFrame()
             {StompHeader::Session, "42"}, // This is made up.
         }
     };
+    if (!s_heartBeat.empty() ) {
+        frame = StompFrame {
+            error,
+            StompCommand::Connected,
+            {
+                {StompHeader::Version, "1.2"},
+                {StompHeader::Session, "42"},
+                {StompHeader::HeartBeat, s_heartBeat},
+            }
+        };
+    }
     if (error != StompError::Ok) {
         throw std::runtime_error("Unexpected: Invalid mock STOMP frame");
     }
@@ -313,6 +333,10 @@ MockWebSocketClientForStomp::checkSubscription(const StompFrame& frame)
 
 void MockWebSocketClientForStomp::onMessage(const std::string& msg)
 {
+    if (msg == "\n") {
+        ++s_heartBeatsReceived;
+        return;
+    }
     StompError error;
     StompFrame frame {error, msg};
     if (error != StompError::Ok) {
@@ -65,6 +65,10 @@ public:
         std::function<void (boost::system::error_code)> onSend = nullptr
     );
 
+    /*! \brief The strand running the mock callbacks.
+     */
+    boost::asio::strand<boost::asio::io_context::executor_type> getExecutor();
+
     /*! \brief Mock close.
      */
     void close(
@@ -102,6 +106,8 @@ public:
     static std::string s_username;
     static std::string s_password;
     static std::vector<std::string> s_subscriptionMessages;
+    static std::string s_heartBeat; // Sent in the CONNECTED frame if not empty.
+    static int s_heartBeatsReceived;
 
     /*! \brief Mock constructor.
      */